@@ -0,0 +1,65 @@
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../minunit.h"
+#include "../extensions/cpp/minunit_cpp.hpp"
+
+/* Code under test */
+constexpr int square(int x) {
+    return x * x;
+}
+
+static std::string greet(const std::string &name) {
+    return "Hello, " + name + "!";
+}
+
+/* Compile-time tests */
+MU_STATIC_TEST(square(3) == 9);
+MU_STATIC_TEST(square(-4) == 16);
+
+/* A functor test */
+struct vector_test {
+    void operator()() const {
+        std::vector<int> values{1, 2, 3};
+        values.push_back(4);
+        MU_EXPECT_EQ(std::size_t{4}, values.size());
+        MU_EXPECT_EQ(4, values.back());
+    }
+};
+
+/* A table of lambda tests, built at compile time */
+constexpr minunit::test_case tests[] = {
+    {"test_square", [] {
+        MU_EXPECT_EQ(25, square(5));
+    }},
+    {"test_greet", [] {
+        MU_EXPECT_EQ(std::string("Hello, World!"), greet("World"));
+    }},
+    {"test_c_string", [] {
+        const char *expected = "minunit";
+        char actual[] = "minunit";
+        MU_EXPECT_EQ(expected, actual);
+    }},
+    {"test_fail", [] {
+        MU_EXPECT_EQ(std::string("Hello, minunit!"), greet("World"));
+    }},
+    {"test_throw", [] {
+        std::vector<int> values{1, 2, 3};
+        MU_EXPECT_EQ(4, values.at(3));  /* Designed to fail: throws std::out_of_range */
+    }},
+};
+
+int main(int argc, char *argv[]) {
+    /* Handle --list and --run <test> */
+    MU_PARSE_ARGS(argc, argv);
+
+    /* Run the table and a functor through the regular runner */
+    minunit::run_tests(tests);
+    minunit::run_test("test_vector", vector_test{});
+
+    /* Print test results */
+    MU_REPORT();
+
+    /* Return number of failures */
+    return MU_EXIT_CODE;
+}
@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "../minunit.h"
+#include "../extensions/faults/minunit_faults.h"
+
+#define EXAMPLE_FILE "faults_minunit_example.tmp"
+
+/* Code under test: copies a file into a new buffer, or returns NULL */
+static char *read_file(const char *path, size_t size) {
+    char *buffer;
+    ssize_t got;
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return NULL;
+    buffer = malloc(size + 1);
+    if (!buffer) {
+        close(fd);
+        return NULL;
+    }
+    got = read(fd, buffer, size);
+    close(fd);
+    if (got < 0) {
+        free(buffer);
+        return NULL;
+    }
+    buffer[got] = '\0';
+    return buffer;
+}
+
+/* Same, but forgets to check malloc */
+static char *read_file_unchecked(const char *path, size_t size) {
+    char *buffer = malloc(size + 1);
+    ssize_t got;
+    int fd = open(path, O_RDONLY);
+    if (fd == -1) return NULL;
+    got = read(fd, buffer, size);
+    close(fd);
+    buffer[got < 0 ? 0 : got] = '\0';
+    return buffer;
+}
+
+/* Test setup and teardown functions */
+static void setup(void) {
+    FILE *file = fopen(EXAMPLE_FILE, "w");
+    if (file) {
+        fputs("minunit", file);
+        fclose(file);
+    }
+}
+
+static void teardown(void) {
+    remove(EXAMPLE_FILE);
+}
+
+/* A single injected failure */
+MU_TEST(test_malloc_failure) {
+    mu_inject_fail("malloc", 1);
+    mu_check(read_file(EXAMPLE_FILE, 7) == NULL);
+}
+
+/* Swept tests: must hold whichever call fails */
+MU_TEST(test_read_file) {
+    char *contents = read_file(EXAMPLE_FILE, 7);
+    mu_check(contents == NULL || strcmp(contents, "minunit") == 0);
+    free(contents);
+}
+
+MU_TEST(test_read_file_unchecked) {
+    char *contents = read_file_unchecked(EXAMPLE_FILE, 7);
+    mu_check(contents == NULL || strcmp(contents, "minunit") == 0);
+    free(contents);
+}
+
+/* Test suite */
+MU_TEST_SUITE(test_suite) {
+    /* Configure setup and teardown for all tests */
+    MU_SUITE_CONFIGURE(setup, teardown);
+
+    /* Run tests */
+    MU_RUN_TEST(test_malloc_failure);
+    MU_RUN_TEST_SWEEP(test_read_file);
+    MU_RUN_TEST_SWEEP(test_read_file_unchecked);  /* Designed to fail */
+}
+
+int main(int argc, char *argv[]) {
+    /* Handle --list and --run <test> */
+    MU_PARSE_ARGS(argc, argv);
+
+    /* Count and inject failures in every test */
+    mu_faults_start();
+
+    /* Run the test suite */
+    MU_RUN_SUITE(test_suite);
+
+    /* Print test results */
+    MU_REPORT();
+
+    /* Return number of failures */
+    return MU_EXIT_CODE;
+}
@@ -0,0 +1,39 @@
+#include <stdio.h>
+#include "../minunit.h"
+#include "../extensions/fuzz/minunit_fuzz.h"
+
+/* Code under test: parses a "MU1" header, with a bug behind "MU1!" */
+static int parse_header(const unsigned char *data, size_t size) {
+    if (size < 4) return -1;
+    if (data[0] != 'M') return -1;
+    if (data[1] != 'U') return -1;
+    if (data[2] != '1') return -1;
+    if (data[3] == '!') return 2;  /* Bug: only -1 and 1 are valid results */
+    return 1;
+}
+
+/* Fuzz test: replays fuzz_corpus/test_parse_header, or fuzzes with --fuzz */
+MU_FUZZ(test_parse_header, data, size) {
+    int result = parse_header(data, size);
+    mu_check(result == -1 || result == 1);
+}
+
+/* Test suite */
+MU_TEST_SUITE(test_suite) {
+    MU_RUN_TEST(test_parse_header);
+}
+
+int main(int argc, char *argv[]) {
+    /* Handle --list, --run <test> and --fuzz=<test> */
+    MU_PARSE_ARGS(argc, argv);
+    mu_fuzz_parse_args(argc, argv);
+
+    /* Run the test suite */
+    MU_RUN_SUITE(test_suite);
+
+    /* Print test results */
+    MU_REPORT();
+
+    /* Return number of failures */
+    return MU_EXIT_CODE;
+}
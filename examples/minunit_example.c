@@ -38,9 +38,8 @@ MU_TEST_SUITE(test_suite) {
 }
 
 int main(int argc, char *argv[]) {
-    /* Mark command line arguments as intentionally unused */
-    UNUSED(argc);
-    UNUSED(argv);
+    /* Handle --list and --run <test> */
+    MU_PARSE_ARGS(argc, argv);
 
     /* Run the test suite */
     MU_RUN_SUITE(test_suite);
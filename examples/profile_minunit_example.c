@@ -0,0 +1,47 @@
+#include <stdio.h>
+#include "../minunit.h"
+#include "../extensions/profile/minunit_profile.h"
+
+/* Code under test: a naive and a memoized Fibonacci */
+unsigned long fib_naive(int n) {
+    return n < 2 ? (unsigned long)n : fib_naive(n - 1) + fib_naive(n - 2);
+}
+
+unsigned long fib_memo(int n) {
+    static unsigned long memo[94];
+    if (n < 2) return (unsigned long)n;
+    if (!memo[n]) memo[n] = fib_memo(n - 1) + fib_memo(n - 2);
+    return memo[n];
+}
+
+/* Test cases: the slow one shows fib_naive in its profile */
+MU_TEST(test_fib_naive) {
+    mu_check(fib_naive(32) == 2178309);
+}
+
+MU_TEST(test_fib_memo) {
+    mu_check(fib_memo(90) == 2880067194370816120UL);
+}
+
+/* Test suite */
+MU_TEST_SUITE(test_suite) {
+    MU_RUN_TEST(test_fib_naive);
+    MU_RUN_TEST(test_fib_memo);
+}
+
+int main(int argc, char *argv[]) {
+    /* Handle --list and --run <test> */
+    MU_PARSE_ARGS(argc, argv);
+
+    /* Handle --profile[=dir] */
+    mu_profile_parse_args(argc, argv);
+
+    /* Run the test suite */
+    MU_RUN_SUITE(test_suite);
+
+    /* Print test results */
+    MU_REPORT();
+
+    /* Return number of failures */
+    return MU_EXIT_CODE;
+}
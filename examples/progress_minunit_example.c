@@ -0,0 +1,58 @@
+#include <stdio.h>
+#include "../minunit.h"
+#include "../extensions/progress/minunit_progress.h"
+
+/* Code under test */
+static unsigned long collatz_steps(unsigned long n) {
+    unsigned long steps = 0;
+    while (n != 1) {
+        n = (n % 2) ? 3 * n + 1 : n / 2;
+        steps++;
+    }
+    return steps;
+}
+
+/* Test cases */
+MU_TEST(test_collatz_small) {
+    mu_check(collatz_steps(1) == 0);
+    mu_check(collatz_steps(3) == 7);
+}
+
+MU_TEST(test_collatz_sweep) {
+    unsigned long n;
+    unsigned long longest = 0;
+    for (n = 1; n < 200000; n++) {
+        unsigned long steps = collatz_steps(n);
+        if (steps > longest) longest = steps;
+    }
+    mu_check(longest == 382);
+}
+
+MU_TEST(test_collatz_fail) {
+    mu_assert(collatz_steps(3) == 8, "This test is designed to fail");
+}
+
+/* Test suite */
+MU_TEST_SUITE(test_suite) {
+    MU_RUN_TEST(test_collatz_small);
+    MU_RUN_TEST(test_collatz_sweep);
+    MU_RUN_TEST(test_collatz_fail);
+}
+
+int main(int argc, char *argv[]) {
+    /* Handle --list and --run <test> */
+    MU_PARSE_ARGS(argc, argv);
+
+    /* Publish progress; set MINUNIT_PROGRESS_FILE or MINUNIT_PROGRESS_INTERVAL to watch it */
+    mu_progress_start(3);
+
+    /* Run the test suite */
+    MU_RUN_SUITE(test_suite);
+    mu_progress_finish();
+
+    /* Print test results */
+    MU_REPORT();
+
+    /* Return number of failures */
+    return MU_EXIT_CODE;
+}
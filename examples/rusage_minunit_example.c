@@ -0,0 +1,71 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../minunit.h"
+#include "../extensions/resources/minunit_rusage.h"
+
+/* Code under test: a cache that is supposed to hold at most one block */
+#define BLOCK_SIZE (4 * 1024 * 1024)
+
+static char *cache_block = NULL;
+static char *leaked_blocks[4];
+static int leaked_count = 0;
+
+static void cache_store(char fill, int keep_old) {
+    if (cache_block && keep_old && leaked_count < 4) {
+        leaked_blocks[leaked_count++] = cache_block;  /* Bug: the old block is never freed */
+    } else {
+        free(cache_block);
+    }
+    cache_block = (char *)malloc(BLOCK_SIZE);
+    if (cache_block) memset(cache_block, fill, BLOCK_SIZE);
+}
+
+/* Test cases */
+MU_TEST(test_cache_bounded) {
+    int i;
+    for (i = 0; i < 4; i++) cache_store((char)i, 0);
+    mu_check(cache_block != NULL);
+    mu_assert_rss_growth_le(BLOCK_SIZE / 1024 + 1024);
+}
+
+MU_TEST(test_cache_page_faults) {
+    cache_store('x', 0);
+    mu_assert_page_faults_le(4 * (BLOCK_SIZE / 4096));
+}
+
+MU_TEST(test_cache_leak) {
+    int i;
+    for (i = 0; i < 4; i++) cache_store((char)i, 1);
+    mu_assert_rss_growth_le(BLOCK_SIZE / 1024 + 1024);  /* Designed to fail: old blocks leak */
+}
+
+/* Test suite */
+MU_TEST_SUITE(test_suite) {
+    MU_RUN_TEST(test_cache_bounded);
+    MU_RUN_TEST(test_cache_page_faults);
+    MU_RUN_TEST(test_cache_leak);
+}
+
+int main(int argc, char *argv[]) {
+    int i;
+
+    /* Handle --list and --run <test> */
+    MU_PARSE_ARGS(argc, argv);
+
+    /* Record the resource usage of every test */
+    mu_rusage_start();
+
+    /* Run the test suite */
+    MU_RUN_SUITE(test_suite);
+
+    /* Print test results and resource usage */
+    MU_REPORT();
+    MU_REPORT_RUSAGE();
+
+    free(cache_block);
+    for (i = 0; i < leaked_count; i++) free(leaked_blocks[i]);
+
+    /* Return number of failures */
+    return MU_EXIT_CODE;
+}
@@ -0,0 +1,41 @@
+#define _GNU_SOURCE  /* Enables thread pinning in the stress extension */
+#include <stdio.h>
+#include "../minunit.h"
+#include "../extensions/stress/minunit_stress.h"
+
+/* Code under test: a lock-free counter */
+static unsigned long counter = 0;
+
+static unsigned long counter_next(void) {
+    return __atomic_add_fetch(&counter, 1, __ATOMIC_RELAXED);
+}
+
+/* Stress tests */
+MU_STRESS(test_counter_increments, 4, 0.2) {
+    unsigned long before = __atomic_load_n(&counter, __ATOMIC_RELAXED);
+    mu_stress_check(counter_next() > before);
+}
+
+MU_STRESS(test_counter_fails, 2, 0.2) {
+    mu_stress_assert(mu_iteration < 1000, "This test is designed to fail");
+}
+
+/* Test suite */
+MU_TEST_SUITE(test_suite) {
+    MU_RUN_TEST(test_counter_increments);
+    MU_RUN_TEST(test_counter_fails);
+}
+
+int main(int argc, char *argv[]) {
+    /* Handle --list and --run <test> */
+    MU_PARSE_ARGS(argc, argv);
+
+    /* Run the test suite */
+    MU_RUN_SUITE(test_suite);
+
+    /* Print test results */
+    MU_REPORT();
+
+    /* Return number of failures */
+    return MU_EXIT_CODE;
+}
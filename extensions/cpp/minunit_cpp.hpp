@@ -0,0 +1,202 @@
+#ifndef MINUNIT_CPP_HPP
+#define MINUNIT_CPP_HPP
+
+#if !(__cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L))
+#error "minunit_cpp.hpp requires C++17"
+#endif
+
+#include "minunit.h"
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+/**
+ * Branch hints for the assertion fast path.
+ *
+ * Passing assertions stay inline with no formatting code in sight; the
+ * failure report lives in a separate cold function.
+ */
+#if defined(__GNUC__)
+#define MINUNIT_CPP_LIKELY(x) __builtin_expect(!!(x), 1)
+#define MINUNIT_CPP_COLD __attribute__((cold, noinline))
+#elif defined(_MSC_VER)
+#define MINUNIT_CPP_LIKELY(x) (x)
+#define MINUNIT_CPP_COLD __declspec(noinline)
+#else
+#define MINUNIT_CPP_LIKELY(x) (x)
+#define MINUNIT_CPP_COLD
+#endif
+
+namespace minunit {
+
+/**
+ * A test: its name and a captureless body.
+ *
+ * Captureless lambdas convert to the body pointer in constant expressions,
+ * so whole test tables can be built at compile time:
+ *
+ *   constexpr minunit::test_case tests[] = {
+ *       {"test_add", [] { MU_EXPECT_EQ(4, add(2, 2)); }},
+ *       {"test_name", [] { MU_EXPECT_EQ(std::string("ok"), name()); }},
+ *   };
+ */
+struct test_case {
+    const char *name;
+    void (*body)();
+};
+
+/*  Name of the test being run, used in failure messages */
+inline const char *current_test = nullptr;
+
+namespace detail {
+
+/*  Records an exception that escaped a test body as the test's failure */
+MINUNIT_CPP_COLD inline void report_exception(const char *name, const char *what)
+{
+    (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n\tuncaught exception: %s", name, what);
+    minunit_status = 1;
+}
+
+/*  Runs a test body, turning any exception it throws into a failure */
+template <typename Body>
+void invoke(const char *name, Body &&body)
+{
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+    try {
+        std::forward<Body>(body)();
+    } catch (const std::exception &e) {
+        report_exception(name, e.what());
+    } catch (...) {
+        report_exception(name, "unknown type");
+    }
+#else
+    (void)name;
+    std::forward<Body>(body)();
+#endif
+}
+
+} /* namespace detail */
+
+/**
+ * Runs one test, lambda or functor, under a name.
+ *
+ * Goes through the same runner as MU_RUN_TEST: setup and teardown, hooks,
+ * --list and --run, and the minunit counters and report. An exception
+ * thrown by the body fails the test, and the run goes on.
+ */
+template <typename Body>
+void run_test(const char *name, Body &&body)
+{
+    current_test = name;
+    MU__RUN_NAMED_TEST(name, detail::invoke(name, std::forward<Body>(body)));
+    current_test = nullptr;
+}
+
+/*  Runs every test of a table, in order */
+template <std::size_t N>
+void run_tests(const test_case (&tests)[N])
+{
+    for (const test_case &test : tests) {
+        run_test(test.name, test.body);
+    }
+}
+
+namespace detail {
+
+template <typename T, typename = void>
+struct is_streamable : std::false_type {};
+
+template <typename T>
+struct is_streamable<T, std::void_t<decltype(std::declval<std::ostream &>() << std::declval<const T &>())>>
+    : std::true_type {};
+
+template <typename T>
+constexpr bool is_c_string = std::is_same_v<std::decay_t<T>, const char *> || std::is_same_v<std::decay_t<T>, char *>;
+
+/*  Equality, comparing C strings by content rather than by address */
+template <typename E, typename R>
+inline bool equal(const E &expected, const R &result)
+{
+    if constexpr (is_c_string<E> && is_c_string<R>) {
+        const char *e = expected;
+        const char *r = result;
+        if (!e || !r) return e == r;
+        return std::strcmp(e, r) == 0;
+    } else {
+        return expected == result;
+    }
+}
+
+/*  Formats any streamable value; other types are described by size */
+template <typename T>
+std::string format(const T &value)
+{
+    if constexpr (is_c_string<T>) {
+        const char *text = value;
+        if (!text) return "<null pointer>";
+        return std::string("'") + text + "'";
+    } else if constexpr (std::is_same_v<T, std::string>) {
+        return "'" + value + "'";
+    } else if constexpr (is_streamable<T>::value) {
+        std::ostringstream out;
+        out << value;
+        return out.str();
+    } else {
+        return "<" + std::to_string(sizeof(T)) + "-byte object>";
+    }
+}
+
+template <typename E, typename R>
+MINUNIT_CPP_COLD void report_eq(const E &expected, const R &result, const char *result_expr,
+    const char *func, const char *file, int line)
+{
+    (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n\t%s:%d: %s: %s expected but was %s",
+        current_test ? current_test : func, file, line, result_expr,
+        format(expected).c_str(), format(result).c_str());
+    minunit_status = 1;
+}
+
+} /* namespace detail */
+
+/**
+ * Checks that two values are equal, counting the assertion.
+ *
+ * Returns false and records a failure message formatted from the values
+ * themselves when they differ. Prefer the MU_EXPECT_EQ() macro, which
+ * supplies the location and ends the test on failure.
+ */
+template <typename E, typename R>
+inline bool expect_eq(const E &expected, const R &result, const char *result_expr,
+    const char *func, const char *file, int line)
+{
+    minunit_assert++;
+    if (MINUNIT_CPP_LIKELY(detail::equal(expected, result))) return true;
+    detail::report_eq(expected, result, result_expr, func, file, line);
+    return false;
+}
+
+} /* namespace minunit */
+
+/**
+ * Assert that two values of any comparable types are equal.
+ *
+ * Ends the test, lambda or function, on failure. Values are formatted
+ * with operator<< when available.
+ */
+#define MU_EXPECT_EQ(expected, result) MU__SAFE_BLOCK(\
+    if (!::minunit::expect_eq((expected), (result), #result, __func__, __FILE__, __LINE__)) return;\
+)
+
+/**
+ * A compile-time test: fails the build, not the run, when condition is
+ * false. condition must be a constant expression, such as a call to a
+ * constexpr function.
+ */
+#define MU_STATIC_TEST(condition) static_assert(condition, #condition)
+
+#endif /* MINUNIT_CPP_HPP */
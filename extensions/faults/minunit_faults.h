@@ -0,0 +1,333 @@
+#ifndef MINUNIT_FAULTS_H
+#define MINUNIT_FAULTS_H
+
+/**
+ * Fault injection for malloc, read, write and open.
+ *
+ * The functions are intercepted with the linker's symbol wrapping, so the
+ * test binary must be linked with
+ *
+ *   -Wl,--wrap=malloc,--wrap=read,--wrap=write,--wrap=open
+ *
+ * and this header included in exactly one of its translation units. Only
+ * calls made from code linked into the binary are intercepted; calls made
+ * inside the C library itself (printf, fopen, ...) are not. Build without
+ * _FORTIFY_SOURCE, which renames read and open to checked variants.
+ */
+
+#include "minunit.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/*  Functions that can be made to fail */
+#define MINUNIT_FAULT_MALLOC 0
+#define MINUNIT_FAULT_READ 1
+#define MINUNIT_FAULT_WRITE 2
+#define MINUNIT_FAULT_OPEN 3
+#define MINUNIT_FAULT_COUNT 4
+
+/* Fault injection state */
+static const char *const minunit_fault_names[MINUNIT_FAULT_COUNT] = { "malloc", "read", "write", "open" };
+static const int minunit_fault_errno[MINUNIT_FAULT_COUNT] = { ENOMEM, EIO, EIO, EACCES };
+static long minunit_fault_calls[MINUNIT_FAULT_COUNT];
+static long minunit_fault_fail_at[MINUNIT_FAULT_COUNT];
+static int minunit_faults_armed = 0;
+
+/*  The original functions, provided by the linker */
+void *__real_malloc(size_t size);
+ssize_t __real_read(int fd, void *buffer, size_t count);
+ssize_t __real_write(int fd, const void *buffer, size_t count);
+int __real_open(const char *path, int flags, ...);
+
+/**
+ * Counts a call to function while a test runs, and returns nonzero when
+ * this call is the one that must fail.
+ */
+MU__MAYBE_UNUSED static int mu_faults_should_fail(int function)
+{
+    if (!minunit_faults_armed) return 0;
+    if (++minunit_fault_calls[function] != minunit_fault_fail_at[function]) return 0;
+    errno = minunit_fault_errno[function];
+    return 1;
+}
+
+void *__wrap_malloc(size_t size)
+{
+    if (mu_faults_should_fail(MINUNIT_FAULT_MALLOC)) return NULL;
+    return __real_malloc(size);
+}
+
+ssize_t __wrap_read(int fd, void *buffer, size_t count)
+{
+    if (mu_faults_should_fail(MINUNIT_FAULT_READ)) return -1;
+    return __real_read(fd, buffer, count);
+}
+
+ssize_t __wrap_write(int fd, const void *buffer, size_t count)
+{
+    if (mu_faults_should_fail(MINUNIT_FAULT_WRITE)) return -1;
+    return __real_write(fd, buffer, count);
+}
+
+int __wrap_open(const char *path, int flags, ...)
+{
+    mode_t mode = 0;
+    if (flags & O_CREAT) {
+        va_list args;
+        va_start(args, flags);
+        mode = (mode_t)va_arg(args, int);
+        va_end(args);
+    }
+    if (mu_faults_should_fail(MINUNIT_FAULT_OPEN)) return -1;
+    return __real_open(path, flags, mode);
+}
+
+/*  Index of a function by name, or -1 */
+MU__MAYBE_UNUSED static int mu_faults_find(const char *function)
+{
+    int i;
+    for (i = 0; i < MINUNIT_FAULT_COUNT; i++) {
+        if (strcmp(minunit_fault_names[i], function) == 0) return i;
+    }
+    return -1;
+}
+
+/**
+ * Clears all injected failures and call counts.
+ */
+MU__MAYBE_UNUSED static void mu_inject_reset(void)
+{
+    memset(minunit_fault_calls, 0, sizeof(minunit_fault_calls));
+    memset(minunit_fault_fail_at, 0, sizeof(minunit_fault_fail_at));
+}
+
+/**
+ * Makes the nth call to function ("malloc", "read", "write" or "open")
+ * made by the current test fail, setting errno as the real function
+ * would: ENOMEM for malloc, EIO for read and write, EACCES for open.
+ * Calls are counted from the start of the test; only that one call fails.
+ *
+ * Returns 0, or -1 if function cannot be injected.
+ */
+MU__MAYBE_UNUSED static int mu_inject_fail(const char *function, long nth)
+{
+    int index = mu_faults_find(function);
+    if (index < 0) return -1;
+    minunit_fault_fail_at[index] = nth;
+    return 0;
+}
+
+/**
+ * Returns the number of calls to function made by the current test, or
+ * by the last test once it has ended; -1 for an unknown function.
+ */
+MU__MAYBE_UNUSED static long mu_inject_calls(const char *function)
+{
+    int index = mu_faults_find(function);
+    return index < 0 ? -1 : minunit_fault_calls[index];
+}
+
+/**
+ * Test lifecycle hook that counts calls only while a test body runs, and
+ * starts every test without injected failures.
+ */
+MU__MAYBE_UNUSED static void mu_faults_hook(const char *test_name, int phase)
+{
+    UNUSED(test_name);
+    if (phase == MU_HOOK_BEGIN) {
+        mu_inject_reset();
+        minunit_faults_armed = 1;
+    } else {
+        minunit_faults_armed = 0;
+    }
+}
+
+/**
+ * Enables fault injection for all tests.
+ *
+ * Usage: mu_faults_start(); ... MU_RUN_SUITE(suite);
+ */
+MU__MAYBE_UNUSED static void mu_faults_start(void)
+{
+    MU_ADD_HOOK(mu_faults_hook);
+}
+
+/*  Outcome of one injection point, sent from the child to the parent */
+struct minunit_fault_result {
+    int status;
+    int asserts;
+    char message[MINUNIT_MESSAGE_LEN];
+};
+
+/*  A running child of a sweep */
+struct minunit_fault_child {
+    pid_t pid;
+    int fd;
+    int function;
+    long nth;
+};
+
+/**
+ * Runs test in a child process with call nth of function failing, between
+ * the suite's setup and teardown. Returns the child, with pid -1 if it
+ * could not be started.
+ */
+MU__MAYBE_UNUSED static struct minunit_fault_child mu_faults_spawn(void (*test)(void), int function, long nth)
+{
+    struct minunit_fault_child child;
+    int fds[2];
+
+    child.pid = -1;
+    child.fd = -1;
+    child.function = function;
+    child.nth = nth;
+    if (pipe(fds) == -1) return child;
+
+    (void)fflush(stdout);
+    child.pid = fork();
+    if (child.pid == 0) {
+        struct minunit_fault_result result;
+        int null_fd = __real_open("/dev/null", O_WRONLY, 0);
+
+        /* Keep the output of thousands of runs off the terminal */
+        if (null_fd != -1) (void)dup2(null_fd, STDOUT_FILENO);
+        (void)close(fds[0]);
+
+        mu_inject_reset();
+        minunit_fault_fail_at[function] = nth;
+        minunit_status = 0;
+        minunit_assert = 0;
+        if (minunit_setup) (*minunit_setup)();
+        minunit_faults_armed = 1;
+        test();
+        minunit_faults_armed = 0;
+        if (minunit_teardown) (*minunit_teardown)();
+
+        memset(&result, 0, sizeof(result));
+        result.status = minunit_status;
+        result.asserts = minunit_assert;
+        (void)snprintf(result.message, MINUNIT_MESSAGE_LEN, "%s", minunit_last_message);
+        (void)__real_write(fds[1], &result, sizeof(result));
+        _exit(0);
+    }
+    (void)close(fds[1]);
+    if (child.pid == -1) {
+        (void)close(fds[0]);
+    } else {
+        child.fd = fds[0];
+    }
+    return child;
+}
+
+/**
+ * Waits for a child of a sweep and records its outcome. The first failing
+ * injection point becomes the test's failure message.
+ */
+MU__MAYBE_UNUSED static void mu_faults_reap(const char *name, struct minunit_fault_child *child, int *failed)
+{
+    struct minunit_fault_result result;
+    ssize_t got;
+    int status = 0;
+
+    memset(&result, 0, sizeof(result));
+    got = __real_read(child->fd, &result, sizeof(result));
+    (void)close(child->fd);
+    (void)waitpid(child->pid, &status, 0);
+
+    minunit_assert += result.asserts;
+    if (*failed) return;
+    if (WIFSIGNALED(status)) {
+        (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n\tcrashed with signal %d when call %ld of %s failed",
+            name, WTERMSIG(status), child->nth, minunit_fault_names[child->function]);
+        *failed = 1;
+    } else if (got != (ssize_t)sizeof(result) || (WIFEXITED(status) && WEXITSTATUS(status) != 0)) {
+        (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n\texited early when call %ld of %s failed",
+            name, child->nth, minunit_fault_names[child->function]);
+        *failed = 1;
+    } else if (result.status) {
+        (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%.*s\n\twhen call %ld of %s failed",
+            MINUNIT_MESSAGE_LEN / 2, result.message, child->nth, minunit_fault_names[child->function]);
+        *failed = 1;
+    }
+}
+
+/**
+ * Runs test once normally to count its calls to each function, then once
+ * more per call with that call failing, each run in its own child process
+ * between its own setup and teardown. Children run as many at a time as
+ * there are online CPUs, or one at a time when the suite has a setup or
+ * teardown: fixtures such as files live outside the process, and running
+ * children must not remove them from under each other. The test fails if
+ * any run fails an assertion or crashes.
+ *
+ * Used by MU_RUN_TEST_SWEEP(); requires mu_faults_start().
+ */
+MU__MAYBE_UNUSED static void mu_faults_sweep(const char *name, void (*test)(void))
+{
+    struct minunit_fault_child *running;
+    long calls[MINUNIT_FAULT_COUNT];
+    long workers = sysconf(_SC_NPROCESSORS_ONLN);
+    long active = 0;
+    long nth = 1;
+    int function = 0;
+    int failed = 0;
+    long i;
+
+    test();
+    if (minunit_status) return;
+
+    /* Every child starts from a fresh fixture, set up and torn down by itself */
+    minunit_faults_armed = 0;
+    memcpy(calls, minunit_fault_calls, sizeof(calls));
+    if (minunit_teardown) (*minunit_teardown)();
+    if (workers < 1 || minunit_setup || minunit_teardown) workers = 1;
+    running = (struct minunit_fault_child *)calloc((size_t)workers, sizeof(*running));
+    if (!running) {
+        (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n\tout of memory", name);
+        minunit_status = 1;
+        return;
+    }
+
+    for (;;) {
+        /* Advance to the next injection point, if any */
+        while (function < MINUNIT_FAULT_COUNT && nth > calls[function]) {
+            function++;
+            nth = 1;
+        }
+        if ((function == MINUNIT_FAULT_COUNT || failed || active == workers) && active > 0) {
+            mu_faults_reap(name, &running[0], &failed);
+            for (i = 1; i < active; i++) running[i - 1] = running[i];
+            active--;
+            continue;
+        }
+        if (function == MINUNIT_FAULT_COUNT || failed) break;
+
+        running[active] = mu_faults_spawn(test, function, nth);
+        if (running[active].pid == -1) {
+            (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n\tcannot fork: %s", name, strerror(errno));
+            failed = 1;
+            continue;
+        }
+        active++;
+        nth++;
+    }
+
+    free(running);
+    memcpy(minunit_fault_calls, calls, sizeof(calls));
+    if (minunit_setup) (*minunit_setup)();
+    if (failed) minunit_status = 1;
+}
+
+/**
+ * Runs a test once per failure point of malloc, read, write and open.
+ * Usage: MU_RUN_TEST_SWEEP(my_test)
+ */
+#define MU_RUN_TEST_SWEEP(test) MU__RUN_NAMED_TEST(#test, mu_faults_sweep(#test, test))
+
+#endif /* MINUNIT_FAULTS_H */
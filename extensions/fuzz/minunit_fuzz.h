@@ -0,0 +1,582 @@
+#ifndef MINUNIT_FUZZ_H
+#define MINUNIT_FUZZ_H
+
+/**
+ * Fuzz tests: MU_FUZZ() tests that run over a corpus of inputs, and can
+ * run a coverage-guided mutation fuzzer.
+ *
+ * Normally a fuzz test runs its body once per file in its corpus
+ * directory and its crashes/ subdirectory, as regression inputs. Started with --fuzz=<test>, that test
+ * instead mutates its corpus for a while, keeping inputs that reach new
+ * code and saving any input that fails or crashes the body.
+ *
+ * Coverage feedback requires compiling the code under test with
+ * -fsanitize-coverage=trace-pc-guard (Clang) or -fsanitize-coverage=trace-pc
+ * (Clang, GCC); without it the fuzzer still runs, blind. The coverage
+ * callbacks are defined here, so include this header in exactly one
+ * translation unit. They must not be instrumented themselves, which takes
+ * the no_sanitize_coverage attribute of Clang or GCC 12 and later: with an
+ * older GCC, build that translation unit without coverage.
+ */
+
+#include "minunit.h"
+#include "../timing/minunit_timer.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+
+/*  Maximum size of an input generated by the fuzzer */
+#define MINUNIT_FUZZ_MAX_LEN 4096
+
+/*  Maximum number of inputs kept in the fuzzer's corpus */
+#define MINUNIT_FUZZ_MAX_CORPUS 4096
+
+/*  Size of the coverage map, in counters; at most 65536 */
+#define MINUNIT_FUZZ_MAP_SIZE 16384
+
+/*  Default corpus directory; each test uses its own subdirectory */
+#define MINUNIT_FUZZ_CORPUS "fuzz_corpus"
+
+/*  Longest path of a corpus file */
+#define MINUNIT_FUZZ_PATH_LEN 512
+
+/*  Default fuzzing time, in seconds */
+#define MINUNIT_FUZZ_SECONDS 10.0
+
+/*  An input that runs this long, in seconds, is reported as a hang */
+#define MINUNIT_FUZZ_TIMEOUT 1.0
+
+/*  The coverage callbacks, and the fuzzer itself, must not be instrumented */
+#if defined(__clang__)
+#define MU__FUZZ_NO_COVERAGE __attribute__((no_sanitize("coverage")))
+#elif defined(__GNUC__) && __GNUC__ >= 12
+#define MU__FUZZ_NO_COVERAGE __attribute__((no_sanitize_coverage))
+#else
+#define MU__FUZZ_NO_COVERAGE
+#endif
+
+/**
+ * State shared between the test process and its fuzzing worker: progress
+ * counters, and the input being run so that it survives a crash.
+ */
+struct minunit_fuzz_shared {
+    unsigned long long execs;
+    int asserts;
+    int corpus;
+    int features;
+    int failed;
+    size_t size;
+    unsigned char input[MINUNIT_FUZZ_MAX_LEN];
+    char message[MINUNIT_MESSAGE_LEN];
+};
+
+/* Fuzzer state */
+static const char *minunit_fuzz_target = NULL;
+static double minunit_fuzz_seconds = MINUNIT_FUZZ_SECONDS;
+static unsigned char minunit_fuzz_map[MINUNIT_FUZZ_MAP_SIZE];
+static unsigned char minunit_fuzz_seen[MINUNIT_FUZZ_MAP_SIZE];
+static unsigned short minunit_fuzz_touched[MINUNIT_FUZZ_MAP_SIZE];
+static int minunit_fuzz_touched_count = 0;
+static uintptr_t minunit_fuzz_prev = 0;
+static unsigned long long minunit_fuzz_rng = 0;
+static unsigned char *minunit_fuzz_corpus[MINUNIT_FUZZ_MAX_CORPUS];
+static size_t minunit_fuzz_corpus_len[MINUNIT_FUZZ_MAX_CORPUS];
+static int minunit_fuzz_corpus_count = 0;
+
+/**
+ * Counts a hit of a coverage map entry, saturating at 255. Entries hit for
+ * the first time in a run are listed, so that only those are scanned and
+ * cleared after the run rather than the whole map.
+ */
+#define MU__FUZZ_HIT(index) MU__SAFE_BLOCK(\
+    unsigned char *minunit_counter = &minunit_fuzz_map[index];\
+    if (*minunit_counter == 0) minunit_fuzz_touched[minunit_fuzz_touched_count++] = (unsigned short)(index);\
+    if (*minunit_counter != 255) (*minunit_counter)++;\
+)
+
+/**
+ * Coverage callbacks for -fsanitize-coverage=trace-pc-guard: every edge
+ * gets a guard, numbered once at startup, that indexes the coverage map.
+ */
+MU__FUZZ_NO_COVERAGE void __sanitizer_cov_trace_pc_guard_init(uint32_t *start, uint32_t *stop)
+{
+    static uint32_t next = 0;
+    if (start == stop || *start) return;
+    for (; start < stop; start++) {
+        *start = 1 + (next++ % (MINUNIT_FUZZ_MAP_SIZE - 1));
+    }
+}
+
+MU__FUZZ_NO_COVERAGE void __sanitizer_cov_trace_pc_guard(uint32_t *guard)
+{
+    MU__FUZZ_HIT(*guard);
+}
+
+/**
+ * Coverage callback for -fsanitize-coverage=trace-pc: called with no
+ * identifier, so edges are told apart by hashing the caller's address
+ * with the previous one.
+ */
+MU__FUZZ_NO_COVERAGE void __sanitizer_cov_trace_pc(void)
+{
+    uintptr_t pc = (uintptr_t)__builtin_return_address(0);
+    pc = (pc ^ (pc >> 15)) * 0x9E3779B1u;
+    MU__FUZZ_HIT((pc ^ minunit_fuzz_prev) % MINUNIT_FUZZ_MAP_SIZE);
+    minunit_fuzz_prev = pc >> 1;
+}
+
+/*  xorshift64* pseudo-random numbers */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static unsigned long long mu_fuzz_random(void)
+{
+    minunit_fuzz_rng ^= minunit_fuzz_rng >> 12;
+    minunit_fuzz_rng ^= minunit_fuzz_rng << 25;
+    minunit_fuzz_rng ^= minunit_fuzz_rng >> 27;
+    return minunit_fuzz_rng * 2685821657736338717ULL;
+}
+
+/*  FNV-1a hash, used to name saved inputs */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static unsigned long long mu_fuzz_hash(const unsigned char *data, size_t size)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    size_t i;
+    for (i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/*  Directory of a test's corpus: $MINUNIT_FUZZ_CORPUS/<test> */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static void mu_fuzz_dir(char *path, size_t len, const char *name, const char *sub)
+{
+    const char *corpus = getenv("MINUNIT_FUZZ_CORPUS");
+    if (!corpus || !corpus[0]) corpus = MINUNIT_FUZZ_CORPUS;
+    (void)snprintf(path, len, "%s/%s%s%s", corpus, name, sub ? "/" : "", sub ? sub : "");
+}
+
+/**
+ * Saves an input as <dir>/<prefix><hash>, creating the directories as
+ * needed. Returns the path in path.
+ */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static void mu_fuzz_save(const char *name, const char *sub, const char *prefix,
+    const unsigned char *data, size_t size, char *path, size_t len)
+{
+    char dir[MINUNIT_FUZZ_PATH_LEN];
+    const char *corpus = getenv("MINUNIT_FUZZ_CORPUS");
+    FILE *file;
+
+    if (!corpus || !corpus[0]) corpus = MINUNIT_FUZZ_CORPUS;
+    (void)mkdir(corpus, 0755);
+    mu_fuzz_dir(dir, sizeof(dir), name, NULL);
+    (void)mkdir(dir, 0755);
+    if (sub) {
+        mu_fuzz_dir(dir, sizeof(dir), name, sub);
+        (void)mkdir(dir, 0755);
+    }
+    (void)snprintf(path, len, "%s/%s%016llx", dir, prefix, mu_fuzz_hash(data, size));
+    file = fopen(path, "wb");
+    if (file) {
+        (void)fwrite(data, 1, size, file);
+        (void)fclose(file);
+    }
+}
+
+/*  Adds a copy of an input to the in-memory corpus */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static void mu_fuzz_add(const unsigned char *data, size_t size)
+{
+    unsigned char *copy;
+    if (minunit_fuzz_corpus_count == MINUNIT_FUZZ_MAX_CORPUS) return;
+    if (size > MINUNIT_FUZZ_MAX_LEN) size = MINUNIT_FUZZ_MAX_LEN;
+    copy = (unsigned char *)malloc(size ? size : 1);
+    if (!copy) return;
+    memcpy(copy, data, size);
+    minunit_fuzz_corpus[minunit_fuzz_corpus_count] = copy;
+    minunit_fuzz_corpus_len[minunit_fuzz_corpus_count] = size;
+    minunit_fuzz_corpus_count++;
+}
+
+/**
+ * Reads a file into a new buffer. Returns NULL on error.
+ */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static unsigned char *mu_fuzz_read(const char *path, size_t *size)
+{
+    FILE *file = fopen(path, "rb");
+    unsigned char *data = NULL;
+    long length;
+
+    if (!file) return NULL;
+    if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+        data = (unsigned char *)malloc(length ? (size_t)length : 1);
+        if (data && fread(data, 1, (size_t)length, file) != (size_t)length) {
+            free(data);
+            data = NULL;
+        }
+        *size = (size_t)length;
+    }
+    (void)fclose(file);
+    return data;
+}
+
+/**
+ * Names a failing input in the failure message, reported under the test's
+ * name rather than its body's.
+ */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static void mu_fuzz_report(const char *name, const char *message, const char *path)
+{
+    char copy[MINUNIT_MESSAGE_LEN];
+    const char *detail = strstr(message, " failed:\n");
+
+    (void)snprintf(copy, sizeof(copy), "%s", detail ? detail + 9 : message);
+    (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n%.*s\n\tinput: %s",
+        name, MINUNIT_MESSAGE_LEN / 2 - 16, copy, path);
+}
+
+/**
+ * Runs body over every file of a directory, stopping at the first failing
+ * input and naming it in the failure message. Returns the number of
+ * inputs run.
+ */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static int mu_fuzz_replay(const char *name, const char *dir,
+    void (*body)(const unsigned char *data, size_t size))
+{
+    char path[MINUNIT_FUZZ_PATH_LEN];
+    struct dirent *entry;
+    struct stat st;
+    DIR *corpus = opendir(dir);
+    int inputs = 0;
+
+    while (corpus && !minunit_status && (entry = readdir(corpus)) != NULL) {
+        unsigned char *data;
+        size_t size = 0;
+
+        if (entry->d_name[0] == '.') continue;
+        (void)snprintf(path, sizeof(path), "%.255s/%.255s", dir, entry->d_name);
+        if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+        data = mu_fuzz_read(path, &size);
+        if (!data) continue;
+        body(data, size);
+        free(data);
+        inputs++;
+        if (minunit_status) mu_fuzz_report(name, minunit_last_message, path);
+    }
+    if (corpus) (void)closedir(corpus);
+    return inputs;
+}
+
+/**
+ * Runs body over every file of the test's corpus directory and of its
+ * crashes/ subdirectory, so that inputs found by the fuzzer keep failing
+ * until the bug is fixed; over an empty input when there is none.
+ */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static void mu_fuzz_regress(const char *name, void (*body)(const unsigned char *data, size_t size))
+{
+    char dir[MINUNIT_FUZZ_PATH_LEN];
+    int inputs;
+
+    mu_fuzz_dir(dir, sizeof(dir), name, NULL);
+    inputs = mu_fuzz_replay(name, dir, body);
+    mu_fuzz_dir(dir, sizeof(dir), name, "crashes");
+    if (!minunit_status) inputs += mu_fuzz_replay(name, dir, body);
+    if (inputs == 0) body((const unsigned char *)"", 0);
+}
+
+/**
+ * Mutates buffer in place, stacking one to four random edits: bit flips,
+ * random and interesting bytes, small arithmetic, insertions, erasures,
+ * copies within the input, and splices with another corpus input.
+ * Returns the new size.
+ */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static size_t mu_fuzz_mutate(unsigned char *buffer, size_t size)
+{
+    static const unsigned char interesting[] = { 0x00, 0x01, 0x10, 0x20, 0x7f, 0x80, 0xff, '0', 'A', '\n' };
+    int edits = 1 + (int)(mu_fuzz_random() % 4);
+
+    while (edits--) {
+        size_t at = size ? (size_t)(mu_fuzz_random() % size) : 0;
+        switch (mu_fuzz_random() % 8) {
+        case 0:
+            if (size) buffer[at] ^= (unsigned char)(1u << (mu_fuzz_random() % 8));
+            break;
+        case 1:
+            if (size) buffer[at] = (unsigned char)mu_fuzz_random();
+            break;
+        case 2:
+            if (size) buffer[at] = interesting[mu_fuzz_random() % sizeof(interesting)];
+            break;
+        case 3:
+            if (size) buffer[at] = (unsigned char)(buffer[at] + (int)(mu_fuzz_random() % 35) - 17);
+            break;
+        case 4:
+            if (size < MINUNIT_FUZZ_MAX_LEN) {
+                at = (size_t)(mu_fuzz_random() % (size + 1));
+                memmove(buffer + at + 1, buffer + at, size - at);
+                buffer[at] = (unsigned char)mu_fuzz_random();
+                size++;
+            }
+            break;
+        case 5:
+            if (size > 1) {
+                size_t n = 1 + (size_t)(mu_fuzz_random() % (size - at));
+                memmove(buffer + at, buffer + at + n, size - at - n);
+                size -= n;
+            }
+            break;
+        case 6:
+            if (size > 1) {
+                size_t from = (size_t)(mu_fuzz_random() % size);
+                size_t n = 1 + (size_t)(mu_fuzz_random() % (size - (from > at ? from : at)));
+                memmove(buffer + at, buffer + from, n);
+            }
+            break;
+        default:
+            if (minunit_fuzz_corpus_count > 0) {
+                int other = (int)(mu_fuzz_random() % (unsigned long long)minunit_fuzz_corpus_count);
+                size_t n = minunit_fuzz_corpus_len[other];
+                at = (size_t)(mu_fuzz_random() % (size + 1));
+                if (at + n > MINUNIT_FUZZ_MAX_LEN) n = MINUNIT_FUZZ_MAX_LEN - at;
+                memcpy(buffer + at, minunit_fuzz_corpus[other], n);
+                if (at + n > size) size = at + n;
+            }
+            break;
+        }
+    }
+    return size;
+}
+
+/**
+ * Counts coverage features of the last run not seen before, marks them
+ * seen, and clears the map for the next run. Hit counts are bucketed as in
+ * AFL (1, 2, 3, 4-7, 8-15, 16-31, 32-127, 128+), so running a loop more
+ * often also counts as progress.
+ */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static int mu_fuzz_new_features(void)
+{
+    int found = 0;
+    int n;
+    for (n = 0; n < minunit_fuzz_touched_count; n++) {
+        unsigned short i = minunit_fuzz_touched[n];
+        unsigned char hits = minunit_fuzz_map[i];
+        unsigned char bucket;
+        minunit_fuzz_map[i] = 0;
+        bucket = hits >= 128 ? 128 : hits >= 32 ? 64 : hits >= 16 ? 32 : hits >= 8 ? 16 : hits >= 4 ? 8 : hits;
+        if (!(minunit_fuzz_seen[i] & bucket)) {
+            minunit_fuzz_seen[i] |= bucket;
+            found++;
+        }
+    }
+    minunit_fuzz_touched_count = 0;
+    return found;
+}
+
+/**
+ * Fuzzing worker: loads the corpus, then mutates and runs inputs until
+ * deadline. Exits with status 1 as soon as the body fails an assertion.
+ */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static void mu_fuzz_worker(const char *name, void (*body)(const unsigned char *data, size_t size),
+    struct minunit_fuzz_shared *shared, double deadline)
+{
+    char dir[MINUNIT_FUZZ_PATH_LEN];
+    char path[MINUNIT_FUZZ_PATH_LEN];
+    unsigned char buffer[MINUNIT_FUZZ_MAX_LEN];
+    struct dirent *entry;
+    DIR *corpus;
+    int found;
+    int asserts;
+    int null_fd = open("/dev/null", O_WRONLY);
+
+    /* Passing assertions print; keep hundreds of thousands of lines away */
+    if (null_fd != -1) (void)dup2(null_fd, STDOUT_FILENO);
+
+    mu_fuzz_dir(dir, sizeof(dir), name, NULL);
+    corpus = opendir(dir);
+    while (corpus && (entry = readdir(corpus)) != NULL) {
+        unsigned char *data;
+        size_t size = 0;
+        if (entry->d_name[0] == '.') continue;
+        (void)snprintf(path, sizeof(path), "%.255s/%.255s", dir, entry->d_name);
+        data = mu_fuzz_read(path, &size);
+        if (data) mu_fuzz_add(data, size);
+        free(data);
+    }
+    if (corpus) (void)closedir(corpus);
+    if (minunit_fuzz_corpus_count == 0) mu_fuzz_add((const unsigned char *)"", 0);
+    (void)mu_fuzz_new_features();
+    asserts = minunit_assert;
+
+    for (;;) {
+        int pick = (int)(mu_fuzz_random() % (unsigned long long)minunit_fuzz_corpus_count);
+        size_t size = minunit_fuzz_corpus_len[pick];
+        unsigned char *input;
+
+        if ((shared->execs & 255) == 0 && mu_timer_real() >= deadline) break;
+
+        memcpy(buffer, minunit_fuzz_corpus[pick], size);
+        size = mu_fuzz_mutate(buffer, size);
+        memcpy(shared->input, buffer, size);
+        shared->size = size;
+
+        /* An exactly sized copy, so memory checkers catch overreads */
+        input = (unsigned char *)malloc(size ? size : 1);
+        if (!input) continue;
+        memcpy(input, buffer, size);
+        minunit_fuzz_prev = 0;
+        minunit_status = 0;
+        body(input, size);
+        free(input);
+        shared->asserts = minunit_assert - asserts;
+        shared->execs++;
+
+        if (minunit_status) {
+            (void)snprintf(shared->message, MINUNIT_MESSAGE_LEN, "%s", minunit_last_message);
+            shared->failed = 1;
+            _exit(1);
+        }
+        found = mu_fuzz_new_features();
+        if (found > 0) {
+            mu_fuzz_add(buffer, size);
+            mu_fuzz_save(name, NULL, "", buffer, size, path, sizeof(path));
+            shared->corpus++;
+            shared->features += found;
+        }
+    }
+    _exit(0);
+}
+
+/**
+ * Fuzzes body for minunit_fuzz_seconds. The corpus grows with every input
+ * that reaches new coverage. The first input that fails an assertion,
+ * crashes or hangs is saved under crashes/ in the corpus directory and
+ * reported as the test's failure.
+ *
+ * The inputs run in a worker forked from this process, so the program is
+ * set up once and every input runs in-process at full speed; a crash only
+ * costs the worker.
+ */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static void mu_fuzz_loop(const char *name, void (*body)(const unsigned char *data, size_t size))
+{
+    struct minunit_fuzz_shared *shared;
+    double start = mu_timer_real();
+    double deadline = start + minunit_fuzz_seconds;
+    double progress_time = start;
+    unsigned long long progress = 0;
+    char path[MINUNIT_FUZZ_PATH_LEN];
+    const char *problem = NULL;
+    struct timespec pause;
+    int status = 0;
+    pid_t pid;
+
+    shared = (struct minunit_fuzz_shared *)mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n\tcannot map shared memory", name);
+        minunit_status = 1;
+        return;
+    }
+    memset(shared, 0, sizeof(*shared));
+    if (!minunit_fuzz_rng) minunit_fuzz_rng = ((unsigned long long)time(NULL) << 20) ^ (unsigned long long)getpid();
+
+    (void)fflush(stdout);
+    pid = fork();
+    if (pid == 0) mu_fuzz_worker(name, body, shared, deadline);
+    if (pid == -1) {
+        (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n\tcannot fork: %s", name, strerror(errno));
+        minunit_status = 1;
+        (void)munmap(shared, sizeof(*shared));
+        return;
+    }
+
+    /* Watch for hangs: the execution counter must keep moving */
+    pause.tv_sec = 0;
+    pause.tv_nsec = 10000000;
+    while (waitpid(pid, &status, WNOHANG) == 0) {
+        double now = mu_timer_real();
+        if (shared->execs != progress) {
+            progress = shared->execs;
+            progress_time = now;
+        } else if (now - progress_time > MINUNIT_FUZZ_TIMEOUT) {
+            (void)kill(pid, SIGKILL);
+            (void)waitpid(pid, &status, 0);
+            problem = "timed out";
+            break;
+        }
+        (void)nanosleep(&pause, NULL);
+    }
+
+    if (!problem && WIFSIGNALED(status)) problem = "crashed";
+    if (!problem && shared->failed) problem = "failed";
+    if (!problem && (!WIFEXITED(status) || WEXITSTATUS(status) != 0)) problem = "exited";
+
+    printf("[FUZZ] %s: %llu execs in %.1f s (%.0f execs/s), %d new coverage features, %d new corpus inputs\n",
+        name, shared->execs, mu_timer_real() - start,
+        shared->execs / (mu_timer_real() - start), shared->features, shared->corpus);
+
+    minunit_assert += shared->asserts;
+    if (problem) {
+        mu_fuzz_save(name, "crashes", "crash-", shared->input, shared->size, path, sizeof(path));
+        if (shared->failed) {
+            mu_fuzz_report(name, shared->message, path);
+        } else {
+            (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n\t%s on input %s",
+                name, problem, path);
+        }
+        minunit_status = 1;
+    }
+    (void)munmap(shared, sizeof(*shared));
+}
+
+/*  Runs a fuzz test: fuzzing if it is the --fuzz target, regression otherwise */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static void mu_fuzz_run(const char *name, void (*body)(const unsigned char *data, size_t size))
+{
+    if (minunit_fuzz_target && strcmp(minunit_fuzz_target, name) == 0) {
+        mu_fuzz_loop(name, body);
+    } else {
+        mu_fuzz_regress(name, body);
+    }
+}
+
+/**
+ * Enables fuzzing from the command line:
+ * - --fuzz=<test> fuzzes that test instead of replaying its corpus
+ * - --fuzz-seconds=<n> fuzzes for n seconds (MINUNIT_FUZZ_SECONDS)
+ * - --fuzz-seed=<n> makes the run reproducible
+ *
+ * Usage: mu_fuzz_parse_args(argc, argv);
+ */
+MU__MAYBE_UNUSED MU__FUZZ_NO_COVERAGE static void mu_fuzz_parse_args(int argc, char *argv[])
+{
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--fuzz=", 7) == 0) {
+            minunit_fuzz_target = argv[i] + 7;
+        } else if (strncmp(argv[i], "--fuzz-seconds=", 15) == 0) {
+            minunit_fuzz_seconds = atof(argv[i] + 15);
+        } else if (strncmp(argv[i], "--fuzz-seed=", 12) == 0) {
+            minunit_fuzz_rng = strtoull(argv[i] + 12, NULL, 10) | 1;
+        }
+    }
+}
+
+/**
+ * Defines a fuzz test taking an input of size bytes at data. Use the
+ * regular assertions in the body; run it like any other test, with
+ * MU_RUN_TEST(name).
+ *
+ * Usage:
+ *   MU_FUZZ(test_parse, data, size) {
+ *       struct header header;
+ *       if (parse_header(data, size, &header) == 0) mu_check(header.length <= size);
+ *   }
+ */
+#define MU_FUZZ(name, data, size) \
+    static void name##_fuzz(const unsigned char *data, size_t size);\
+    MU_TEST(name) { mu_fuzz_run(#name, name##_fuzz); }\
+    static void name##_fuzz(const unsigned char *data, size_t size)
+
+#endif /* MINUNIT_FUZZ_H */
@@ -0,0 +1,332 @@
+#ifndef MINUNIT_PROFILE_H
+#define MINUNIT_PROFILE_H
+
+#include "minunit.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+
+/*  Stack sampling needs backtrace(), available from glibc and macOS */
+#if defined(__GLIBC__) || (defined(__APPLE__) && defined(__MACH__))
+#define MINUNIT_PROFILE_BACKTRACE 1
+#include <execinfo.h>
+#endif
+
+/**
+ * Maximum number of samples kept for a single test. When a test fills it,
+ * every other sample is discarded and only every other signal sampled
+ * from then on, so the profile covers the whole test at a coarser rate.
+ */
+#define MINUNIT_PROFILE_MAX_SAMPLES 2048
+
+/*  Maximum number of stack frames captured per sample */
+#define MINUNIT_PROFILE_DEPTH 32
+
+/*  Sampling interval, in microseconds of CPU time */
+#define MINUNIT_PROFILE_INTERVAL_US 1000
+
+/*  Default directory for the folded-stack files */
+#define MINUNIT_PROFILE_DIR "minunit_profile"
+
+/**
+ * Frames at the top of every sample that belong to the profiler: the
+ * signal handler and the kernel's signal return trampoline.
+ */
+#define MINUNIT_PROFILE_SKIP 2
+
+/*  Keeps helpers of the signal handler out of its stack at any -O level */
+#if defined(__GNUC__)
+#define MU__PROFILE_INLINE __inline__ __attribute__((always_inline))
+#else
+#define MU__PROFILE_INLINE
+#endif
+
+/* Profiler state */
+static const char *minunit_profile_dir = NULL;
+static volatile sig_atomic_t minunit_profile_active = 0;
+static int minunit_profile_stride = 1;
+static unsigned int minunit_profile_ticks = 0;
+static int minunit_profile_count = 0;
+static int minunit_profile_written = 0;
+static int minunit_profile_dropped = 0;
+static void *minunit_profile_frames[MINUNIT_PROFILE_MAX_SAMPLES][MINUNIT_PROFILE_DEPTH];
+static int minunit_profile_depth[MINUNIT_PROFILE_MAX_SAMPLES];
+
+/**
+ * Arms the CPU time interval timer that delivers SIGPROF every interval
+ * microseconds, or disarms it when interval is 0.
+ */
+MU__MAYBE_UNUSED static void mu_profile_timer(long interval)
+{
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    timer.it_interval.tv_sec = interval / 1000000;
+    timer.it_interval.tv_usec = interval % 1000000;
+    timer.it_value = timer.it_interval;
+    (void)setitimer(ITIMER_PROF, &timer, NULL);
+}
+
+/**
+ * Halves the samples of a full buffer, keeping every other one, and
+ * doubles the number of signals per sample to match; the timer itself
+ * cannot be slowed reliably, as it fires on the kernel's tick. Runs in the handler that
+ * claimed the first slot past the end, once the other handlers are done
+ * with their slots.
+ */
+MU__MAYBE_UNUSED static void mu_profile_downsample(void)
+{
+    long spins;
+    int i;
+
+    for (spins = 0; spins < 100000000L; spins++) {
+        if (__atomic_load_n(&minunit_profile_written, __ATOMIC_ACQUIRE) >= MINUNIT_PROFILE_MAX_SAMPLES) break;
+    }
+    for (i = 1; i < MINUNIT_PROFILE_MAX_SAMPLES / 2; i++) {
+        memcpy(minunit_profile_frames[i], minunit_profile_frames[2 * i], sizeof(minunit_profile_frames[i]));
+        minunit_profile_depth[i] = minunit_profile_depth[2 * i];
+    }
+    __atomic_store_n(&minunit_profile_stride, minunit_profile_stride * 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&minunit_profile_written, MINUNIT_PROFILE_MAX_SAMPLES / 2, __ATOMIC_RELEASE);
+    __atomic_store_n(&minunit_profile_count, MINUNIT_PROFILE_MAX_SAMPLES / 2, __ATOMIC_RELEASE);
+}
+
+/**
+ * Records the interrupted stack. Inlined into the handler, so that the
+ * stack holds exactly MINUNIT_PROFILE_SKIP frames above the test. The timer is process-wide, so this may
+ * run in any thread, several at once: each sample claims its slot
+ * atomically. Samples that arrive while a full buffer is being
+ * downsampled are counted as dropped.
+ */
+MU__MAYBE_UNUSED static MU__PROFILE_INLINE void mu_profile_sample(void)
+{
+    int slot = __atomic_fetch_add(&minunit_profile_count, 1, __ATOMIC_ACQ_REL);
+    if (slot < MINUNIT_PROFILE_MAX_SAMPLES) {
+#ifdef MINUNIT_PROFILE_BACKTRACE
+        minunit_profile_depth[slot] = backtrace(minunit_profile_frames[slot], MINUNIT_PROFILE_DEPTH);
+#else
+        minunit_profile_depth[slot] = 0;
+#endif
+        __atomic_fetch_add(&minunit_profile_written, 1, __ATOMIC_RELEASE);
+    } else if (slot == MINUNIT_PROFILE_MAX_SAMPLES) {
+        mu_profile_downsample();
+    } else {
+        __atomic_fetch_add(&minunit_profile_dropped, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * SIGPROF handler: samples one signal in every minunit_profile_stride
+ * while a test is running.
+ */
+MU__MAYBE_UNUSED static void mu_profile_signal(int sig)
+{
+    int saved_errno = errno;
+    UNUSED(sig);
+    if (minunit_profile_active) {
+        unsigned int tick = __atomic_fetch_add(&minunit_profile_ticks, 1, __ATOMIC_RELAXED);
+        unsigned int stride = (unsigned int)__atomic_load_n(&minunit_profile_stride, __ATOMIC_ACQUIRE);
+        if (tick % stride == 0) mu_profile_sample();
+    }
+    errno = saved_errno;
+}
+
+/**
+ * Reduces a backtrace_symbols() entry to a flame graph frame name.
+ *
+ * "prog(function+0x1a) [0x55d0c]" becomes "function". Frames without a
+ * symbol, such as static functions, keep their module offset, as in
+ * "prog+0x1234", which addr2line can resolve.
+ */
+MU__MAYBE_UNUSED static void mu_profile_frame_name(const char *symbol, char *name, size_t len)
+{
+    const char *open = strchr(symbol, '(');
+    const char *base = symbol;
+    const char *slash;
+    size_t n;
+
+    if (open && open[1] != '+' && open[1] != ')') {
+        n = strcspn(open + 1, "+)");
+        (void)snprintf(name, len, "%.*s", (int)n, open + 1);
+    } else if (open) {
+        for (slash = symbol; slash < open; slash++) {
+            if (*slash == '/') base = slash + 1;
+        }
+        n = strcspn(open + 1, ")");
+        (void)snprintf(name, len, "%.*s%.*s", (int)(open - base), base, (int)n, open + 1);
+    } else {
+        (void)snprintf(name, len, "%s", symbol);
+    }
+    for (n = 0; name[n]; n++) {
+        if (name[n] == ';' || name[n] == ' ') name[n] = '_';
+    }
+}
+
+MU__MAYBE_UNUSED static int mu_profile_compare(const void *a, const void *b)
+{
+    return strcmp(*(char * const *)a, *(char * const *)b);
+}
+
+/**
+ * Writes the samples of a test as <dir>/<test>.folded.
+ *
+ * Each line is a stack, root first with frames separated by ';', followed
+ * by the number of samples that hit it; flamegraph.pl and speedscope read
+ * this format directly.
+ */
+MU__MAYBE_UNUSED static void mu_profile_write(const char *test_name)
+{
+#ifdef MINUNIT_PROFILE_BACKTRACE
+    char path[MINUNIT_MESSAGE_LEN];
+    char name[256];
+    char **stacks;
+    FILE *file;
+    int count = minunit_profile_count;
+    int i, j;
+
+    if (count > MINUNIT_PROFILE_MAX_SAMPLES) count = MINUNIT_PROFILE_MAX_SAMPLES;
+
+    (void)snprintf(path, sizeof(path), "%s/%s.folded", minunit_profile_dir, test_name);
+    file = fopen(path, "w");
+    stacks = (char **)calloc((size_t)count + 1, sizeof(*stacks));
+    if (!file || !stacks) {
+        fprintf(stderr, "minunit: cannot write profile '%s'\n", path);
+        if (file) (void)fclose(file);
+        free(stacks);
+        return;
+    }
+
+    for (i = 0; i < count; i++) {
+        int depth = minunit_profile_depth[i];
+        char **symbols = depth > MINUNIT_PROFILE_SKIP
+            ? backtrace_symbols(minunit_profile_frames[i], depth) : NULL;
+        size_t used = 0;
+
+        for (j = depth - 1; symbols && j >= MINUNIT_PROFILE_SKIP; j--) {
+            char *grown;
+            size_t n;
+            mu_profile_frame_name(symbols[j], name, sizeof(name));
+            n = strlen(name);
+            grown = (char *)realloc(stacks[i], used + n + 2);
+            if (!grown) break;
+            stacks[i] = grown;
+            if (used) stacks[i][used++] = ';';
+            memcpy(stacks[i] + used, name, n + 1);
+            used += n;
+        }
+        free(symbols);
+        if (!stacks[i]) {
+            stacks[i] = (char *)malloc(sizeof("[unknown]"));
+            if (stacks[i]) strcpy(stacks[i], "[unknown]");
+        }
+        if (!stacks[i]) {
+            count = i;
+            break;
+        }
+    }
+
+    /* Identical stacks become adjacent, so each can be counted in one pass */
+    qsort(stacks, (size_t)count, sizeof(*stacks), mu_profile_compare);
+    for (i = 0; i < count; i = j) {
+        for (j = i + 1; j < count && strcmp(stacks[i], stacks[j]) == 0; j++) {
+        }
+        fprintf(file, "%s %d\n", stacks[i], j - i);
+    }
+
+    (void)fclose(file);
+    for (i = 0; i < count; i++) free(stacks[i]);
+    free(stacks);
+#else
+    UNUSED(test_name);
+#endif
+}
+
+/**
+ * Test lifecycle hook that samples each test and writes its profile.
+ */
+MU__MAYBE_UNUSED static void mu_profile_hook(const char *test_name, int phase)
+{
+    if (phase == MU_HOOK_BEGIN) {
+        memset(minunit_profile_depth, 0, sizeof(minunit_profile_depth));
+        minunit_profile_count = 0;
+        minunit_profile_written = 0;
+        minunit_profile_dropped = 0;
+        minunit_profile_stride = 1;
+        minunit_profile_ticks = 0;
+        minunit_profile_active = 1;
+        mu_profile_timer(MINUNIT_PROFILE_INTERVAL_US);
+        return;
+    }
+
+    mu_profile_timer(0);
+    minunit_profile_active = 0;
+    if (minunit_profile_count > 0) mu_profile_write(test_name);
+    if (minunit_profile_dropped > 0) {
+        fprintf(stderr, "minunit: profile of %s dropped %d samples\n", test_name, minunit_profile_dropped);
+    }
+}
+
+/**
+ * Starts sampling every test, writing one folded-stack file per test that
+ * received at least one sample into directory dir (created if needed).
+ *
+ * Samples come from SIGPROF, delivered every MINUNIT_PROFILE_INTERVAL_US
+ * microseconds of CPU time, less often for tests that run long enough to
+ * fill MINUNIT_PROFILE_MAX_SAMPLES; time spent sleeping or blocked is not
+ * sampled. The handler is installed with SA_RESTART so the tests' own
+ * system calls are restarted rather than failing with EINTR.
+ *
+ * Usage: mu_profile_start("profile"); ... MU_RUN_SUITE(suite);
+ */
+MU__MAYBE_UNUSED static void mu_profile_start(const char *dir)
+{
+    struct sigaction action;
+
+#ifdef MINUNIT_PROFILE_BACKTRACE
+    void *warmup[1];
+    /* The first backtrace() call may load libgcc; keep that out of the handler */
+    (void)backtrace(warmup, 1);
+#else
+    fprintf(stderr, "minunit: stack sampling is not supported on this platform\n");
+#endif
+
+    minunit_profile_dir = dir ? dir : MINUNIT_PROFILE_DIR;
+    if (mkdir(minunit_profile_dir, 0755) != 0 && errno != EEXIST) {
+        fprintf(stderr, "minunit: cannot create profile directory '%s'\n", minunit_profile_dir);
+        return;
+    }
+
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = mu_profile_signal;
+    action.sa_flags = SA_RESTART;
+    (void)sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, NULL) != 0) {
+        fprintf(stderr, "minunit: cannot install the SIGPROF handler\n");
+        return;
+    }
+
+    MU_ADD_HOOK(mu_profile_hook);
+}
+
+/**
+ * Enables profiling when the command line contains --profile or
+ * --profile=<dir>. Profiles go to MINUNIT_PROFILE_DIR unless a directory
+ * is given.
+ *
+ * Usage: mu_profile_parse_args(argc, argv);
+ */
+MU__MAYBE_UNUSED static void mu_profile_parse_args(int argc, char *argv[])
+{
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--profile") == 0) {
+            mu_profile_start(NULL);
+        } else if (strncmp(argv[i], "--profile=", 10) == 0) {
+            mu_profile_start(argv[i] + 10);
+        }
+    }
+}
+
+#endif /* MINUNIT_PROFILE_H */
@@ -0,0 +1,222 @@
+#ifndef MINUNIT_PROGRESS_H
+#define MINUNIT_PROGRESS_H
+
+#include "minunit.h"
+#include "../timing/minunit_timer.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#define MU__PROGRESS_PID() ((long)getpid())
+#else
+#include <process.h>
+#define MU__PROGRESS_PID() ((long)_getpid())
+#endif
+
+/**
+ * Size of the progress status record, in bytes.
+ *
+ * The record is a single line of plain text padded with spaces, so an
+ * external watcher can read it with nothing more than `cat`.
+ */
+#define MINUNIT_PROGRESS_LEN 256
+
+/*  Maximum length of the current test name kept in the status */
+#define MINUNIT_PROGRESS_NAME_LEN 64
+
+/*  Default seconds between status lines on an interactive terminal */
+#define MINUNIT_PROGRESS_INTERVAL 0.5
+
+/* Progress state */
+static int minunit_progress_total = 0;
+static double minunit_progress_start_time = 0;
+static double minunit_progress_test_time = 0;
+static double minunit_progress_line_time = 0;
+static double minunit_progress_interval = 0;
+static int minunit_progress_tty = 0;
+static unsigned long minunit_progress_seq = 0;
+static char minunit_progress_test[MINUNIT_PROGRESS_NAME_LEN];
+static char *minunit_progress_block = NULL;
+
+/*  Offset of the last digit of the seq= field in the status record */
+#define MU__PROGRESS_SEQ_END 13
+
+/**
+ * Formats the current status into buffer.
+ *
+ * The line starts with seq= and ends with end=, both carrying the update
+ * counter as ten digits. seq= is even between updates and odd while the
+ * record is being rewritten, as in a seqlock: a watcher takes a
+ * consistent snapshot by reading the line, checking that seq= is even and
+ * equal to end=, then reading seq= once more and checking it is unchanged.
+ * Otherwise it caught the record mid-update and should read it again.
+ *
+ * Fields: tests done/total (total is 0 when unknown), failures,
+ * assertions, assertions per second, elapsed seconds, estimated seconds
+ * remaining (-1 when unknown), the current test and the CLOCK_MONOTONIC
+ * time it started, and the run state.
+ */
+MU__MAYBE_UNUSED static void mu_progress_format(char *buffer, size_t len, const char *state)
+{
+    double now = mu_timer_real();
+    double elapsed = now - minunit_progress_start_time;
+    double rate = elapsed > 0 ? minunit_assert / elapsed : 0;
+    double eta = -1.0;
+
+    if (minunit_progress_total > 0 && minunit_run > 0) {
+        eta = (minunit_progress_total - minunit_run) * (elapsed / minunit_run);
+        if (eta < 0) eta = 0;
+    }
+
+    (void)snprintf(buffer, len,
+        "seq=%010lu pid=%ld done=%d/%d failed=%d asserts=%d rate=%.1f/s elapsed=%.1fs eta=%.1fs "
+        "test=%s started=%.3f state=%s end=%010lu",
+        minunit_progress_seq, MU__PROGRESS_PID(), minunit_run, minunit_progress_total,
+        minunit_fail, minunit_assert, rate, elapsed, eta,
+        minunit_progress_test[0] ? minunit_progress_test : "-",
+        minunit_progress_test_time, state, minunit_progress_seq);
+}
+
+/**
+ * Publishes the current status to the status block and, when due, to the
+ * terminal status line.
+ *
+ * Updates only happen at test boundaries. No timer signal is used, so the
+ * tests' own system calls are never interrupted; a hung test shows up to
+ * a watcher as a started= time that keeps getting older.
+ */
+MU__MAYBE_UNUSED static void mu_progress_update(const char *state, int force_line)
+{
+    char line[MINUNIT_PROGRESS_LEN];
+    double now;
+
+    minunit_progress_seq += 2;
+    mu_progress_format(line, sizeof(line), state);
+
+#if !defined(_WIN32)
+    if (minunit_progress_block) {
+        size_t used = strlen(line);
+        char *block = minunit_progress_block;
+        memset(line + used, ' ', MINUNIT_PROGRESS_LEN - 1 - used);
+        line[MINUNIT_PROGRESS_LEN - 1] = '\n';
+
+        /* Mark the record busy: even to odd never carries, so one byte does */
+        __atomic_store_n(&block[MU__PROGRESS_SEQ_END], (char)('0' + (minunit_progress_seq - 1) % 10), __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(block + MU__PROGRESS_SEQ_END + 1, line + MU__PROGRESS_SEQ_END + 1,
+            MINUNIT_PROGRESS_LEN - MU__PROGRESS_SEQ_END - 1);
+        /* Publish the new even value, its last digit last */
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        memcpy(block, line, MU__PROGRESS_SEQ_END);
+        __atomic_store_n(&block[MU__PROGRESS_SEQ_END], line[MU__PROGRESS_SEQ_END], __ATOMIC_RELEASE);
+        line[used] = '\0';
+    }
+#endif
+
+    if (minunit_progress_interval <= 0) return;
+    now = mu_timer_real();
+    if (!force_line && now - minunit_progress_line_time < minunit_progress_interval) return;
+    minunit_progress_line_time = now;
+
+    if (minunit_progress_tty) {
+        fprintf(stderr, "\r\x1b[K[%d/%d] %d failed, %.0f asserts/s, %s",
+            minunit_run, minunit_progress_total, minunit_fail,
+            now > minunit_progress_start_time ? minunit_assert / (now - minunit_progress_start_time) : 0.0,
+            minunit_progress_test[0] ? minunit_progress_test : "-");
+    } else {
+        fprintf(stderr, "%s\n", line);
+    }
+    (void)fflush(stderr);
+}
+
+/**
+ * Test lifecycle hook that records the current test and publishes status.
+ */
+MU__MAYBE_UNUSED static void mu_progress_hook(const char *test_name, int phase)
+{
+    if (phase == MU_HOOK_BEGIN) {
+        (void)snprintf(minunit_progress_test, MINUNIT_PROGRESS_NAME_LEN, "%s", test_name);
+        minunit_progress_test_time = mu_timer_real();
+    }
+    mu_progress_update("running", 0);
+}
+
+/**
+ * Starts progress telemetry for a run of total_tests tests.
+ *
+ * Pass 0 when the number of tests is unknown; the ETA is then reported
+ * as -1. Call it after MU_PARSE_ARGS(): under --run the total is the one
+ * selected test, and under --list nothing is published. Configuration
+ * comes from the environment:
+ * - MINUNIT_PROGRESS_FILE: path of a status file that is memory-mapped
+ *   and rewritten in place, one fixed-size line, for external watchers
+ * - MINUNIT_PROGRESS_INTERVAL: seconds between status lines on stderr;
+ *   0 disables them. Defaults to MINUNIT_PROGRESS_INTERVAL when stderr
+ *   is a terminal and to 0 otherwise.
+ *
+ * Usage: mu_progress_start(42); ... mu_progress_finish();
+ */
+MU__MAYBE_UNUSED static void mu_progress_start(int total_tests)
+{
+    const char *path = getenv("MINUNIT_PROGRESS_FILE");
+    const char *interval = getenv("MINUNIT_PROGRESS_INTERVAL");
+
+    if (minunit_list) return;
+    minunit_progress_total = minunit_filter ? 1 : total_tests;
+    minunit_progress_start_time = mu_timer_real();
+    minunit_progress_test[0] = '\0';
+
+#if !defined(_WIN32)
+    minunit_progress_tty = isatty(fileno(stderr));
+    if (path && path[0] && !minunit_progress_block) {
+        int fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd != -1) {
+            if (ftruncate(fd, MINUNIT_PROGRESS_LEN) == 0) {
+                void *map = mmap(NULL, MINUNIT_PROGRESS_LEN, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                if (map != MAP_FAILED) minunit_progress_block = (char *)map;
+            }
+            (void)close(fd);
+        }
+        if (!minunit_progress_block) {
+            fprintf(stderr, "minunit: cannot map progress file '%s'\n", path);
+        }
+    }
+#else
+    UNUSED(path);
+#endif
+
+    if (interval && interval[0]) {
+        minunit_progress_interval = atof(interval);
+    } else {
+        minunit_progress_interval = minunit_progress_tty ? MINUNIT_PROGRESS_INTERVAL : 0;
+    }
+
+    MU_ADD_HOOK(mu_progress_hook);
+    mu_progress_update("running", 1);
+}
+
+/**
+ * Publishes the final status and releases the status block.
+ *
+ * The status file is left in place with state=finished so a watcher can
+ * tell a completed run from one that died.
+ */
+MU__MAYBE_UNUSED static void mu_progress_finish(void)
+{
+    if (minunit_list) return;
+    minunit_progress_test[0] = '\0';
+    mu_progress_update("finished", 1);
+    if (minunit_progress_interval > 0 && minunit_progress_tty) {
+        fprintf(stderr, "\n");
+    }
+#if !defined(_WIN32)
+    if (minunit_progress_block) {
+        (void)munmap(minunit_progress_block, MINUNIT_PROGRESS_LEN);
+        minunit_progress_block = NULL;
+    }
+#endif
+}
+
+#endif /* MINUNIT_PROGRESS_H */
@@ -0,0 +1,225 @@
+#ifndef MINUNIT_RUSAGE_H
+#define MINUNIT_RUSAGE_H
+
+#include "minunit.h"
+#include <string.h>
+#include <sys/resource.h>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#endif
+
+/*  Maximum number of tests kept for the resource usage report */
+#define MINUNIT_RUSAGE_MAX_TESTS 256
+
+/*  Maximum length of a test name in the resource usage report */
+#define MINUNIT_RUSAGE_NAME_LEN 64
+
+/**
+ * Resource usage of a process at one point in time.
+ *
+ * Sizes are in kilobytes. rss is the current resident set size, read from
+ * /proc/self/statm where available, and maxrss the peak resident set size
+ * reported by getrusage().
+ */
+struct minunit_rusage_sample {
+    long rss;
+    long maxrss;
+    long minflt;
+    long majflt;
+    long nvcsw;
+    long nivcsw;
+};
+
+/*  Resource usage of one test: the difference between its end and start */
+struct minunit_rusage_record {
+    char test[MINUNIT_RUSAGE_NAME_LEN];
+    struct minunit_rusage_sample delta;
+};
+
+/* Resource usage state */
+static struct minunit_rusage_sample minunit_rusage_begin;
+static struct minunit_rusage_record minunit_rusage_records[MINUNIT_RUSAGE_MAX_TESTS];
+static int minunit_rusage_count = 0;
+static int minunit_rusage_dropped = 0;
+
+/**
+ * Returns the current resident set size in kilobytes, or -1 if the
+ * platform has no cheap way to read it.
+ */
+MU__MAYBE_UNUSED static long mu_rusage_rss_kb(void)
+{
+#if defined(__linux__)
+    /* Plain read() rather than stdio, so sampling does not allocate */
+    char buffer[128];
+    long pages = -1;
+    long resident = -1;
+    ssize_t n;
+    int fd = open("/proc/self/statm", O_RDONLY);
+    if (fd == -1) return -1;
+    n = read(fd, buffer, sizeof(buffer) - 1);
+    (void)close(fd);
+    if (n <= 0) return -1;
+    buffer[n] = '\0';
+    if (sscanf(buffer, "%ld %ld", &pages, &resident) != 2) return -1;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+#else
+    return -1;
+#endif
+}
+
+/**
+ * Takes a resource usage sample of the current process.
+ */
+MU__MAYBE_UNUSED static void mu_rusage_sample(struct minunit_rusage_sample *sample)
+{
+    struct rusage usage;
+
+    memset(sample, 0, sizeof(*sample));
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#if defined(__APPLE__) && defined(__MACH__)
+        sample->maxrss = (long)(usage.ru_maxrss / 1024);  /* Bytes on macOS */
+#else
+        sample->maxrss = (long)usage.ru_maxrss;
+#endif
+        sample->minflt = (long)usage.ru_minflt;
+        sample->majflt = (long)usage.ru_majflt;
+        sample->nvcsw = (long)usage.ru_nvcsw;
+        sample->nivcsw = (long)usage.ru_nivcsw;
+    }
+    sample->rss = mu_rusage_rss_kb();
+}
+
+/**
+ * Returns how much the resident set size grew, in kilobytes, since the
+ * current test started. Falls back to the growth of the peak resident
+ * set size where the current size cannot be read.
+ */
+MU__MAYBE_UNUSED static long mu_rusage_rss_growth(void)
+{
+    struct minunit_rusage_sample now;
+    mu_rusage_sample(&now);
+    if (now.rss >= 0 && minunit_rusage_begin.rss >= 0) {
+        return now.rss - minunit_rusage_begin.rss;
+    }
+    return now.maxrss - minunit_rusage_begin.maxrss;
+}
+
+/**
+ * Returns the number of page faults, minor and major, since the current
+ * test started.
+ */
+MU__MAYBE_UNUSED static long mu_rusage_page_faults(void)
+{
+    struct minunit_rusage_sample now;
+    mu_rusage_sample(&now);
+    return (now.minflt - minunit_rusage_begin.minflt) + (now.majflt - minunit_rusage_begin.majflt);
+}
+
+/**
+ * Test lifecycle hook that records the resource usage of each test.
+ */
+MU__MAYBE_UNUSED static void mu_rusage_hook(const char *test_name, int phase)
+{
+    struct minunit_rusage_sample end;
+    struct minunit_rusage_record *record;
+
+    if (phase == MU_HOOK_BEGIN) {
+        mu_rusage_sample(&minunit_rusage_begin);
+        return;
+    }
+
+    mu_rusage_sample(&end);
+    if (minunit_rusage_count == MINUNIT_RUSAGE_MAX_TESTS) {
+        minunit_rusage_dropped++;
+        return;
+    }
+    record = &minunit_rusage_records[minunit_rusage_count++];
+    (void)snprintf(record->test, MINUNIT_RUSAGE_NAME_LEN, "%s", test_name);
+    record->delta.rss = (end.rss >= 0 && minunit_rusage_begin.rss >= 0) ? end.rss - minunit_rusage_begin.rss : 0;
+    record->delta.maxrss = end.maxrss - minunit_rusage_begin.maxrss;
+    record->delta.minflt = end.minflt - minunit_rusage_begin.minflt;
+    record->delta.majflt = end.majflt - minunit_rusage_begin.majflt;
+    record->delta.nvcsw = end.nvcsw - minunit_rusage_begin.nvcsw;
+    record->delta.nivcsw = end.nivcsw - minunit_rusage_begin.nivcsw;
+}
+
+/**
+ * Starts recording the resource usage of every test.
+ *
+ * Usage: mu_rusage_start(); ... MU_RUN_SUITE(suite); MU_REPORT_RUSAGE();
+ */
+MU__MAYBE_UNUSED static void mu_rusage_start(void)
+{
+    MU_ADD_HOOK(mu_rusage_hook);
+}
+
+/**
+ * Prints the resource usage of every test run since mu_rusage_start().
+ *
+ * Columns: growth of the peak and of the current resident set size in
+ * kilobytes, minor and major page faults, and voluntary and involuntary
+ * context switches.
+ */
+#define MU_REPORT_RUSAGE() MU__SAFE_BLOCK(\
+    int minunit_rusage_i;\
+    if (minunit_list) break;\
+    printf("\nResource usage per test:\n");\
+    printf("%10s %10s %10s %8s %8s %8s  %s\n", "maxrss KB", "rss KB", "minflt", "majflt", "vcsw", "ivcsw", "test");\
+    for (minunit_rusage_i = 0; minunit_rusage_i < minunit_rusage_count; minunit_rusage_i++) {\
+        const struct minunit_rusage_record *minunit_rusage_r = &minunit_rusage_records[minunit_rusage_i];\
+        printf("%+10ld %+10ld %10ld %8ld %8ld %8ld  %s\n",\
+            minunit_rusage_r->delta.maxrss, minunit_rusage_r->delta.rss,\
+            minunit_rusage_r->delta.minflt, minunit_rusage_r->delta.majflt,\
+            minunit_rusage_r->delta.nvcsw, minunit_rusage_r->delta.nivcsw,\
+            minunit_rusage_r->test);\
+    }\
+    if (minunit_rusage_dropped) {\
+        printf("(%d more tests not recorded)\n", minunit_rusage_dropped);\
+    }\
+)
+
+/**
+ * Assert that the resident set size grew by at most limit_kb kilobytes
+ * since the test started.
+ *
+ * Requires mu_rusage_start(). Use it at the end of a test to catch memory
+ * growth that does not show up as time.
+ */
+#define mu_assert_rss_growth_le(limit_kb) MU__SAFE_BLOCK(\
+    long minunit_tmp_l;\
+    long minunit_tmp_r;\
+    minunit_assert++;\
+    minunit_tmp_l = (long)(limit_kb);\
+    minunit_tmp_r = mu_rusage_rss_growth();\
+    if (minunit_tmp_r > minunit_tmp_l) {\
+        (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n\t%s:%d: RSS grew by %ld KB, limit is %ld KB", __func__, __FILE__, __LINE__, minunit_tmp_r, minunit_tmp_l);\
+        minunit_status = 1;\
+        return;\
+    } else {\
+        printf(".");\
+    }\
+)
+
+/**
+ * Assert that at most limit page faults, minor and major, happened since
+ * the test started.
+ *
+ * Requires mu_rusage_start().
+ */
+#define mu_assert_page_faults_le(limit) MU__SAFE_BLOCK(\
+    long minunit_tmp_l;\
+    long minunit_tmp_r;\
+    minunit_assert++;\
+    minunit_tmp_l = (long)(limit);\
+    minunit_tmp_r = mu_rusage_page_faults();\
+    if (minunit_tmp_r > minunit_tmp_l) {\
+        (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n\t%s:%d: %ld page faults, limit is %ld", __func__, __FILE__, __LINE__, minunit_tmp_r, minunit_tmp_l);\
+        minunit_status = 1;\
+        return;\
+    } else {\
+        printf(".");\
+    }\
+)
+
+#endif /* MINUNIT_RUSAGE_H */
@@ -0,0 +1,341 @@
+#ifndef MINUNIT_STRESS_H
+#define MINUNIT_STRESS_H
+
+#include "minunit.h"
+#include "../timing/minunit_timer.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if !defined(__GNUC__)
+#error "minunit_stress.h requires GCC or Clang atomic builtins"
+#endif
+
+/*  Thread pinning needs the GNU affinity API: define _GNU_SOURCE before including minunit.h */
+#if defined(__linux__) && defined(_GNU_SOURCE)
+#define MINUNIT_STRESS_PIN 1
+#include <sched.h>
+#endif
+
+/*  Cheap time stamps from the TSC on x86, unless MINUNIT_STRESS_NO_TSC is defined */
+#if (defined(__x86_64__) || defined(__i386__)) && !defined(MINUNIT_STRESS_NO_TSC)
+#define MINUNIT_STRESS_TSC 1
+#include <x86intrin.h>
+#endif
+
+/**
+ * Histogram resolution: each power of two is split into
+ * 2^(MINUNIT_STRESS_SUB_BITS - 1) buckets, so a recorded latency is off by
+ * at most 1/32 (about 3%) of its value, at every magnitude.
+ */
+#define MINUNIT_STRESS_SUB_BITS 6
+#define MINUNIT_STRESS_HALF (1 << (MINUNIT_STRESS_SUB_BITS - 1))
+#define MINUNIT_STRESS_BUCKETS ((64 - MINUNIT_STRESS_SUB_BITS + 3) * MINUNIT_STRESS_HALF)
+
+/*  Maximum number of threads of a stress test */
+#define MINUNIT_STRESS_MAX_THREADS 256
+
+/*  Duration of the TSC calibration against mu_timer_real(), in seconds */
+#define MINUNIT_STRESS_CALIBRATION 0.01
+
+/*  Result of the last stress test; latencies in nanoseconds */
+struct minunit_stress_result {
+    int threads;
+    double seconds;
+    unsigned long long ops;
+    double ops_per_sec;
+    double p50;
+    double p99;
+    double p999;
+    double max;
+};
+
+/*  Per-thread state, written only by its own thread until it is joined */
+struct minunit_stress_thread {
+    void (*op)(int thread, unsigned long iteration);
+    int index;
+    unsigned long long ops;
+    int asserts;
+    unsigned long long max;
+    unsigned long long buckets[MINUNIT_STRESS_BUCKETS];
+};
+
+/* Stress state */
+static struct minunit_stress_result minunit_stress_last;
+static const char *minunit_stress_name = NULL;
+static int minunit_stress_go = 0;
+static int minunit_stress_stop = 0;
+static int minunit_stress_failed = 0;
+static double minunit_stress_ns_per_tick = 0;
+static __thread struct minunit_stress_thread *minunit_stress_self = NULL;
+
+/**
+ * Returns a time stamp in clock ticks.
+ *
+ * Reads the TSC where available, which costs a few nanoseconds instead of
+ * a clock_gettime() call, and mu_timer_real() otherwise. Convert tick
+ * differences with mu_stress_ticks_to_ns().
+ */
+MU__MAYBE_UNUSED static unsigned long long mu_stress_ticks(void)
+{
+#ifdef MINUNIT_STRESS_TSC
+    return (unsigned long long)__rdtsc();
+#else
+    return (unsigned long long)(mu_timer_real() * 1000000000.0);
+#endif
+}
+
+/**
+ * Calibrates the tick length against mu_timer_real(), once.
+ *
+ * Assumes an invariant TSC, as found on x86 processors of the last decade;
+ * define MINUNIT_STRESS_NO_TSC where that does not hold.
+ */
+MU__MAYBE_UNUSED static void mu_stress_calibrate(void)
+{
+#ifdef MINUNIT_STRESS_TSC
+    double start, elapsed;
+    unsigned long long ticks;
+    if (minunit_stress_ns_per_tick > 0) return;
+    start = mu_timer_real();
+    ticks = mu_stress_ticks();
+    do {
+        elapsed = mu_timer_real() - start;
+    } while (elapsed < MINUNIT_STRESS_CALIBRATION);
+    ticks = mu_stress_ticks() - ticks;
+    minunit_stress_ns_per_tick = ticks ? elapsed * 1000000000.0 / (double)ticks : 1.0;
+#else
+    minunit_stress_ns_per_tick = 1.0;
+#endif
+}
+
+MU__MAYBE_UNUSED static double mu_stress_ticks_to_ns(unsigned long long ticks)
+{
+    return (double)ticks * minunit_stress_ns_per_tick;
+}
+
+/*  Histogram bucket of a value: exact below 2^SUB_BITS, log-linear above */
+MU__MAYBE_UNUSED static int mu_stress_bucket(unsigned long long value)
+{
+    int shift;
+    if (value < 2 * MINUNIT_STRESS_HALF) return (int)value;
+    shift = (63 - __builtin_clzll(value)) - (MINUNIT_STRESS_SUB_BITS - 1);
+    return shift * MINUNIT_STRESS_HALF + (int)(value >> shift);
+}
+
+/*  Smallest value that falls into a histogram bucket */
+MU__MAYBE_UNUSED static unsigned long long mu_stress_bucket_value(int bucket)
+{
+    int shift;
+    if (bucket < 2 * MINUNIT_STRESS_HALF) return (unsigned long long)bucket;
+    shift = bucket / MINUNIT_STRESS_HALF - 1;
+    return (unsigned long long)(bucket - shift * MINUNIT_STRESS_HALF) << shift;
+}
+
+/**
+ * Returns the value at quantile q of a histogram, in ticks: the middle of
+ * the bucket holding it.
+ */
+MU__MAYBE_UNUSED static double mu_stress_quantile(const unsigned long long *buckets, unsigned long long total, double q)
+{
+    unsigned long long rank = (unsigned long long)(q * (double)total);
+    unsigned long long seen = 0;
+    int i;
+
+    if (rank >= total) rank = total ? total - 1 : 0;
+    for (i = 0; i < MINUNIT_STRESS_BUCKETS; i++) {
+        seen += buckets[i];
+        if (seen > rank) {
+            unsigned long long low = mu_stress_bucket_value(i);
+            unsigned long long high = i + 1 < MINUNIT_STRESS_BUCKETS ? mu_stress_bucket_value(i + 1) : low + 1;
+            return ((double)low + (double)high) / 2.0;
+        }
+    }
+    return 0.0;
+}
+
+/**
+ * Worker thread: waits for the common start, then runs the operation
+ * until told to stop, recording the latency of every call.
+ */
+MU__MAYBE_UNUSED static void *mu_stress_worker(void *arg)
+{
+    struct minunit_stress_thread *self = (struct minunit_stress_thread *)arg;
+    unsigned long iteration = 0;
+
+    minunit_stress_self = self;
+    while (!__atomic_load_n(&minunit_stress_go, __ATOMIC_ACQUIRE)) {
+    }
+    while (!__atomic_load_n(&minunit_stress_stop, __ATOMIC_RELAXED)) {
+        unsigned long long start = mu_stress_ticks();
+        unsigned long long ticks;
+        self->op(self->index, iteration++);
+        ticks = mu_stress_ticks() - start;
+        self->buckets[mu_stress_bucket(ticks)]++;
+        if (ticks > self->max) self->max = ticks;
+        self->ops++;
+    }
+    minunit_stress_self = NULL;
+    return NULL;
+}
+
+/**
+ * Runs op on threads threads for duration seconds and reports throughput
+ * and latency percentiles; the result is also kept in minunit_stress_last.
+ *
+ * Each thread records into its own histogram, so the measuring loop never
+ * writes shared memory; histograms are merged once the threads are joined.
+ * With MINUNIT_STRESS_PIN, thread i is pinned to CPU i modulo the number
+ * of online CPUs.
+ */
+MU__MAYBE_UNUSED static void mu_stress_run(const char *name, void (*op)(int thread, unsigned long iteration),
+    int threads, double duration)
+{
+    struct minunit_stress_thread **contexts;
+    pthread_t *ids;
+    unsigned long long *merged;
+    unsigned long long max = 0;
+    struct timespec pause;
+    double start, elapsed;
+    int started = 0;
+    int i, b;
+
+    if (threads < 1) threads = 1;
+    if (threads > MINUNIT_STRESS_MAX_THREADS) threads = MINUNIT_STRESS_MAX_THREADS;
+    mu_stress_calibrate();
+
+    contexts = (struct minunit_stress_thread **)calloc((size_t)threads, sizeof(*contexts));
+    ids = (pthread_t *)calloc((size_t)threads, sizeof(*ids));
+    merged = (unsigned long long *)calloc(MINUNIT_STRESS_BUCKETS, sizeof(*merged));
+    if (!contexts || !ids || !merged) goto out_of_memory;
+
+    minunit_stress_name = name;
+    minunit_stress_go = 0;
+    minunit_stress_stop = 0;
+    minunit_stress_failed = 0;
+    for (i = 0; i < threads; i++) {
+        contexts[i] = (struct minunit_stress_thread *)calloc(1, sizeof(**contexts));
+        if (!contexts[i]) break;
+        contexts[i]->op = op;
+        contexts[i]->index = i;
+        if (pthread_create(&ids[i], NULL, mu_stress_worker, contexts[i]) != 0) break;
+#ifdef MINUNIT_STRESS_PIN
+        {
+            cpu_set_t cpus;
+            long online = sysconf(_SC_NPROCESSORS_ONLN);
+            CPU_ZERO(&cpus);
+            CPU_SET((int)(i % (online > 0 ? online : 1)), &cpus);
+            (void)pthread_setaffinity_np(ids[i], sizeof(cpus), &cpus);
+        }
+#endif
+        started++;
+    }
+
+    start = mu_timer_real();
+    __atomic_store_n(&minunit_stress_go, 1, __ATOMIC_RELEASE);
+    if (started == threads) {
+        /* Sleep in short steps so a failed assertion ends the run early */
+        pause.tv_sec = 0;
+        pause.tv_nsec = 1000000;
+        while (mu_timer_real() - start < duration && !__atomic_load_n(&minunit_stress_failed, __ATOMIC_RELAXED)) {
+            (void)nanosleep(&pause, NULL);
+        }
+    }
+    __atomic_store_n(&minunit_stress_stop, 1, __ATOMIC_RELAXED);
+    for (i = 0; i < started; i++) (void)pthread_join(ids[i], NULL);
+    elapsed = mu_timer_real() - start;
+
+    memset(&minunit_stress_last, 0, sizeof(minunit_stress_last));
+    minunit_stress_last.threads = started;
+    minunit_stress_last.seconds = elapsed;
+    for (i = 0; i < started; i++) {
+        minunit_stress_last.ops += contexts[i]->ops;
+        minunit_assert += contexts[i]->asserts;
+        if (contexts[i]->max > max) max = contexts[i]->max;
+        for (b = 0; b < MINUNIT_STRESS_BUCKETS; b++) merged[b] += contexts[i]->buckets[b];
+    }
+    minunit_stress_last.ops_per_sec = elapsed > 0 ? (double)minunit_stress_last.ops / elapsed : 0;
+    minunit_stress_last.p50 = mu_stress_ticks_to_ns((unsigned long long)mu_stress_quantile(merged, minunit_stress_last.ops, 0.50));
+    minunit_stress_last.p99 = mu_stress_ticks_to_ns((unsigned long long)mu_stress_quantile(merged, minunit_stress_last.ops, 0.99));
+    minunit_stress_last.p999 = mu_stress_ticks_to_ns((unsigned long long)mu_stress_quantile(merged, minunit_stress_last.ops, 0.999));
+    minunit_stress_last.max = mu_stress_ticks_to_ns(max);
+
+    if (started < threads) {
+        (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n\tcould only start %d of %d threads", name, started, threads);
+        minunit_status = 1;
+    } else if (minunit_stress_failed) {
+        minunit_status = 1;
+    }
+    printf("[STRESS] %s: %d threads, %.2f s, %llu ops, %.0f ops/s, p50 %.0f ns, p99 %.0f ns, p999 %.0f ns, max %.0f ns\n",
+        name, minunit_stress_last.threads, minunit_stress_last.seconds, minunit_stress_last.ops,
+        minunit_stress_last.ops_per_sec, minunit_stress_last.p50, minunit_stress_last.p99,
+        minunit_stress_last.p999, minunit_stress_last.max);
+
+    for (i = 0; i < threads; i++) free(contexts[i]);
+    free(contexts);
+    free(ids);
+    free(merged);
+    return;
+
+out_of_memory:
+    free(contexts);
+    free(ids);
+    free(merged);
+    (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n\tout of memory", name);
+    minunit_status = 1;
+}
+
+/**
+ * Records a failure from a stress thread. Only the first failure of a run
+ * writes the message; it also stops all threads.
+ */
+#define MU__STRESS_FAIL(message) MU__SAFE_BLOCK(\
+    int minunit_stress_expected = 0;\
+    if (__atomic_compare_exchange_n(&minunit_stress_failed, &minunit_stress_expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {\
+        (void)snprintf(minunit_last_message, MINUNIT_MESSAGE_LEN, "%s failed:\n\t%s:%d: thread %d: %s", minunit_stress_name, __FILE__, __LINE__, minunit_stress_self ? minunit_stress_self->index : -1, message);\
+    }\
+    __atomic_store_n(&minunit_stress_stop, 1, __ATOMIC_RELAXED);\
+)
+
+/**
+ * Defines a stress test that runs its body as one operation, repeatedly,
+ * on threads threads for duration seconds. Inside the body, mu_thread is
+ * the thread index and mu_iteration the iteration count of that thread.
+ * Run it like any other test, with MU_RUN_TEST(name).
+ *
+ * Usage:
+ *   MU_STRESS(test_queue, 4, 2.0) {
+ *       mu_stress_check(queue_push(&queue, mu_iteration));
+ *   }
+ */
+#define MU_STRESS(name, threads, duration) \
+    static void name##_op(int mu_thread, unsigned long mu_iteration);\
+    MU_TEST(name) { mu_stress_run(#name, name##_op, (threads), (duration)); }\
+    static void name##_op(MU__MAYBE_UNUSED int mu_thread, MU__MAYBE_UNUSED unsigned long mu_iteration)
+
+/**
+ * Thread-safe assertions for stress test bodies.
+ *
+ * Assertions are counted per thread and added to the totals when the run
+ * ends. A failure ends the current operation and stops the run; the
+ * message names the failing thread.
+ */
+#define mu_stress_check(test) MU__SAFE_BLOCK(\
+    if (minunit_stress_self) minunit_stress_self->asserts++;\
+    if (!(test)) {\
+        MU__STRESS_FAIL(#test);\
+        return;\
+    }\
+)
+
+#define mu_stress_assert(test, message) MU__SAFE_BLOCK(\
+    if (minunit_stress_self) minunit_stress_self->asserts++;\
+    if (!(test)) {\
+        MU__STRESS_FAIL(message);\
+        return;\
+    }\
+)
+
+#endif /* MINUNIT_STRESS_H */
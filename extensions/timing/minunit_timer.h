@@ -5,8 +5,8 @@
 #include "minunit.h"
 
 /* Timing variables */
-static double minunit_real_timer = 0;
-static double minunit_proc_timer = 0;
+MU__MAYBE_UNUSED static double minunit_real_timer = 0;
+MU__MAYBE_UNUSED static double minunit_proc_timer = 0;
 
 /**
  * Returns the real time, in seconds, or -1.0 if an error occurred.
@@ -21,7 +21,7 @@ static double minunit_proc_timer = 0;
  * 
  * @return The current real time in seconds, or -1.0 if an error occurred
  */
-static double mu_timer_real(void)
+MU__MAYBE_UNUSED static double mu_timer_real(void)
 {
     struct timespec ts;
     if (clock_gettime(CLOCK_MONOTONIC, &ts) != -1) {
@@ -40,7 +40,7 @@ static double mu_timer_real(void)
  * 
  * @return The CPU time used by the current process in seconds, or -1.0 if an error occurred
  */
-static double mu_timer_cpu(void)
+MU__MAYBE_UNUSED static double mu_timer_cpu(void)
 {
     struct timespec ts;
     if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != -1) {
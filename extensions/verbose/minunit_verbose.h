@@ -35,25 +35,30 @@
 /**
  * Runs a verbose test and handles setup/teardown.
  * Features:
+ * - Honors --list and --run from MU_PARSE_ARGS()
  * - Tracks test timing
  * - Handles test setup and teardown
+ * - Calls registered test lifecycle hooks
  * - Prints colored output for failures
  * - Flushes output for immediate feedback
  * Usage: MU_RUN_TEST_VERBOSE(my_test)
  */
 #define MU_RUN_TEST_VERBOSE(test) MU__SAFE_BLOCK(\
+    if (MU__SKIP_TEST(#test)) break;\
     if (minunit_real_timer==0 && minunit_proc_timer==0) {\
         minunit_real_timer = mu_timer_real();\
         minunit_proc_timer = mu_timer_cpu();\
     }\
     if (minunit_setup) (*minunit_setup)();\
     minunit_status = 0;\
+    MU__RUN_HOOKS(#test, MU_HOOK_BEGIN);\
     char* result = test();\
     minunit_run++;\
     if (result != 0) {\
         minunit_fail++;\
         printf(ANSI_COLOR_RED "[FAIL] %s\n" ANSI_COLOR_RESET, result);\
     }\
+    MU__RUN_HOOKS(#test, MU_HOOK_END);\
     (void)fflush(stdout);\
     if (minunit_teardown) (*minunit_teardown)();\
 )
@@ -61,13 +66,13 @@
 /**
  * Runs a suite of verbose tests.
  * Features:
- * - Prints suite name in yellow
+ * - Prints suite name in yellow, except when only listing tests
  * - Handles suite-level setup/teardown
  * - Resets setup/teardown after suite completion
  * Usage: MU_RUN_SUITE_VERBOSE(my_suite)
  */
 #define MU_RUN_SUITE_VERBOSE(suite_name) do { \
-    printf(ANSI_COLOR_YELLOW "[SUITE] Running %s\n" ANSI_COLOR_RESET, #suite_name); \
+    if (!minunit_list) printf(ANSI_COLOR_YELLOW "[SUITE] Running %s\n" ANSI_COLOR_RESET, #suite_name); \
     suite_name(); \
     minunit_setup = NULL; \
     minunit_teardown = NULL; \
@@ -84,6 +89,7 @@
 #define MU_REPORT_VERBOSE() MU__SAFE_BLOCK(\
     double minunit_end_real_timer;\
     double minunit_end_proc_timer;\
+    if (minunit_list) break;\
     printf(ANSI_BOLD "\n\n=== Test Summary ===\n" ANSI_COLOR_RESET); \
     printf(ANSI_COLOR_BLUE "Tests run: %d\n" ANSI_COLOR_RESET, minunit_run); \
     printf(ANSI_COLOR_MAGENTA "Assertions: %d\n" ANSI_COLOR_RESET, minunit_assert); \
@@ -76,6 +76,7 @@ typedef int clockid_t;
 #endif
 
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
 
 /**
@@ -100,6 +101,16 @@ typedef int clockid_t;
  */
 #define UNUSED(x) ((void)(x))
 
+/**
+ * Marks helpers defined in extension headers that a given test program
+ * may not use, so including an extension never produces unused warnings.
+ */
+#if defined(__GNUC__)
+#define MU__MAYBE_UNUSED __attribute__((unused))
+#else
+#define MU__MAYBE_UNUSED
+#endif
+
 /*  Maximum length of last message */
 #define MINUNIT_MESSAGE_LEN 1024
 
@@ -116,6 +127,37 @@ static char minunit_last_message[MINUNIT_MESSAGE_LEN];
 static void (*minunit_setup)(void) = NULL;
 static void (*minunit_teardown)(void) = NULL;
 
+/*  Maximum number of test lifecycle hooks */
+#define MINUNIT_MAX_HOOKS 8
+
+/*  Hook phases */
+#define MU_HOOK_BEGIN 0
+#define MU_HOOK_END 1
+
+/**
+ * Test lifecycle hooks.
+ *
+ * Extensions register hooks with MU_ADD_HOOK() to observe every test run
+ * by the test runners. Each hook receives the test name and the phase:
+ * MU_HOOK_BEGIN right before the test body runs (after setup), and
+ * MU_HOOK_END once the test has been counted. Begin hooks run in
+ * registration order, end hooks in reverse order, so the first extension
+ * registered brackets all the others.
+ */
+static void (*minunit_hooks[MINUNIT_MAX_HOOKS])(const char *test_name, int phase);
+static int minunit_hook_count = 0;
+
+/**
+ * Test selection for external runners.
+ *
+ * MU_PARSE_ARGS() understands two command line options:
+ * - --list prints one "MU_TEST <name>" line per test instead of running it
+ * - --run <name> runs only the tests called <name>
+ * Other arguments are left for the program and its extensions.
+ */
+static const char *minunit_filter = NULL;
+static int minunit_list = 0;
+
 /*  Definitions */
 #define MU_TEST(method_name) static void method_name(void)
 #define MU_TEST_SUITE(suite_name) static void suite_name(void)
@@ -124,6 +166,23 @@ static void (*minunit_teardown)(void) = NULL;
     block\
 } while(0)
 
+/*  Parse the test selection options from the command line */
+#define MU_PARSE_ARGS(argc, argv) MU__SAFE_BLOCK(\
+    int minunit_arg_i;\
+    for (minunit_arg_i = 1; minunit_arg_i < (argc); minunit_arg_i++) {\
+        if (strcmp((argv)[minunit_arg_i], "--list") == 0) {\
+            minunit_list = 1;\
+        } else if (strcmp((argv)[minunit_arg_i], "--run") == 0 && minunit_arg_i + 1 < (argc)) {\
+            minunit_filter = (argv)[++minunit_arg_i];\
+        }\
+    }\
+)
+
+/*  Whether a test is skipped; in list mode, also prints its name */
+#define MU__SKIP_TEST(test_name) (minunit_list ?\
+    (printf("MU_TEST %s\n", test_name), 1) :\
+    (minunit_filter != NULL && strcmp(minunit_filter, test_name) != 0))
+
 /*  Run test suite and unset setup and teardown functions */
 #define MU_RUN_SUITE(suite_name) MU__SAFE_BLOCK(\
     suite_name();\
@@ -137,23 +196,55 @@ static void (*minunit_teardown)(void) = NULL;
     minunit_teardown = teardown_fun;\
 )
 
-/*  Test runner */
-#define MU_RUN_TEST(test) MU__SAFE_BLOCK(\
+/*  Register a test lifecycle hook, ignoring duplicates */
+#define MU_ADD_HOOK(hook_fun) MU__SAFE_BLOCK(\
+    int minunit_hook_i;\
+    for (minunit_hook_i = 0; minunit_hook_i < minunit_hook_count; minunit_hook_i++) {\
+        if (minunit_hooks[minunit_hook_i] == (hook_fun)) break;\
+    }\
+    if (minunit_hook_i == minunit_hook_count && minunit_hook_count < MINUNIT_MAX_HOOKS) {\
+        minunit_hooks[minunit_hook_count++] = (hook_fun);\
+    }\
+)
+
+/*  Call registered hooks for a test */
+#define MU__RUN_HOOKS(test_name, phase) MU__SAFE_BLOCK(\
+    int minunit_hook_i;\
+    if ((phase) == MU_HOOK_BEGIN) {\
+        for (minunit_hook_i = 0; minunit_hook_i < minunit_hook_count; minunit_hook_i++) {\
+            (*minunit_hooks[minunit_hook_i])(test_name, phase);\
+        }\
+    } else {\
+        for (minunit_hook_i = minunit_hook_count - 1; minunit_hook_i >= 0; minunit_hook_i--) {\
+            (*minunit_hooks[minunit_hook_i])(test_name, phase);\
+        }\
+    }\
+)
+
+/*  Run a test body under a name; shared by MU_RUN_TEST and other front ends */
+#define MU__RUN_NAMED_TEST(test_name, test_call) MU__SAFE_BLOCK(\
+    if (MU__SKIP_TEST(test_name)) break;\
     if (minunit_setup) (*minunit_setup)();\
     minunit_status = 0;\
-    test();\
+    MU__RUN_HOOKS(test_name, MU_HOOK_BEGIN);\
+    test_call;\
     minunit_run++;\
     if (minunit_status) {\
         minunit_fail++;\
         printf("F");\
         printf("\n%s\n", minunit_last_message);\
     }\
+    MU__RUN_HOOKS(test_name, MU_HOOK_END);\
     (void)fflush(stdout);\
     if (minunit_teardown) (*minunit_teardown)();\
 )
 
+/*  Test runner */
+#define MU_RUN_TEST(test) MU__RUN_NAMED_TEST(#test, test())
+
 /*  Report */
 #define MU_REPORT() MU__SAFE_BLOCK(\
+    if (minunit_list) break;\
     printf("\n\n%d tests, %d assertions, %d failures\n", minunit_run, minunit_assert, minunit_fail);\
 )
 
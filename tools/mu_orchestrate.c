@@ -0,0 +1,613 @@
+/*
+ * mu_orchestrate - run the tests of many minunit binaries on a worker pool.
+ *
+ * Each binary is asked for its tests with --list (see MU_PARSE_ARGS() in
+ * minunit.h), and every test then runs in its own process with --run <name>.
+ * Both passes run on the worker pool, longest-first using the durations
+ * recorded by previous runs, which spreads uneven binaries evenly across all
+ * workers. Binaries that list no tests ignored --list and ran as a whole;
+ * that run is their result.
+ *
+ * Usage: mu_orchestrate [-j workers] [-d durations] [-o report] path...
+ *
+ * Each path is a test binary or a directory whose executable files are all
+ * test binaries. The merged report goes to stdout, or to the -o file. The
+ * exit code is 0 when every test passed and 1 otherwise.
+ */
+#if !defined(_POSIX_C_SOURCE) || _POSIX_C_SOURCE < 200809L
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/*  Default file holding the durations of previous runs */
+#define MU_ORCHESTRATE_DURATIONS ".mu_durations"
+
+/*  Maximum length of a line read from a --list output or durations file */
+#define MU_ORCHESTRATE_LINE_LEN 1024
+
+/*  Marker printed before each test name by a test binary in --list mode */
+#define MU_ORCHESTRATE_LIST_PREFIX "MU_TEST "
+
+/*  Test name used for binaries that run as a whole */
+#define MU_ORCHESTRATE_WHOLE "*"
+
+/*  Test name of the discovery job of a binary */
+#define MU_ORCHESTRATE_LIST "--list"
+
+/*  A test to run: one test of a binary, a whole binary, or its discovery */
+struct mu_job {
+    char *binary;
+    char *test;
+    double expected;    /* Duration of the previous run, or -1 */
+    double duration;
+    int status;         /* waitpid() status */
+    int done;           /* Already run during discovery */
+    pid_t pid;
+    char output[64];    /* Path of the captured output */
+};
+
+/*  Duration recorded by a previous run */
+struct mu_history {
+    char *binary;
+    char *test;
+    double duration;
+};
+
+/**
+ * Hash index over the (binary, test) keys of an array. Slots hold an array
+ * index plus one, 0 marking an empty slot; the capacity is a power of two.
+ */
+struct mu_index {
+    size_t *slots;
+    size_t capacity;
+};
+
+/*  A growable array of jobs, indexed by key */
+struct mu_job_list {
+    struct mu_job *items;
+    size_t count;
+    size_t capacity;
+    struct mu_index index;
+};
+
+/*  Discovery jobs, one per binary, then the test jobs they found */
+static struct mu_job_list probes;
+static struct mu_job_list jobs;
+
+static struct mu_history *history = NULL;
+static size_t history_count = 0;
+static struct mu_index history_index;
+
+/*  The orchestrator itself, skipped when scanning directories */
+static struct stat self;
+
+static void *xrealloc(void *ptr, size_t size)
+{
+    void *result = realloc(ptr, size);
+    if (!result) {
+        fprintf(stderr, "mu_orchestrate: out of memory\n");
+        exit(2);
+    }
+    return result;
+}
+
+static char *xstrdup(const char *s)
+{
+    char *result = (char *)xrealloc(NULL, strlen(s) + 1);
+    strcpy(result, s);
+    return result;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) != -1) {
+        return (double)ts.tv_sec + (double)ts.tv_nsec / 1000000000.0;
+    }
+    return 0.0;
+}
+
+/*  FNV-1a hash of a (binary, test) key */
+static size_t hash_key(const char *binary, const char *test)
+{
+    unsigned long long hash = 14695981039346656037ULL;
+    for (; *binary; binary++) hash = (hash ^ (unsigned char)*binary) * 1099511628211ULL;
+    hash = (hash ^ '\t') * 1099511628211ULL;
+    for (; *test; test++) hash = (hash ^ (unsigned char)*test) * 1099511628211ULL;
+    return (size_t)hash;
+}
+
+/*  Returns the key of element i of the indexed array */
+typedef void (*mu_key_fn)(const void *array, size_t i, const char **binary, const char **test);
+
+static void job_key(const void *array, size_t i, const char **binary, const char **test)
+{
+    const struct mu_job *job = (const struct mu_job *)array + i;
+    *binary = job->binary;
+    *test = job->test;
+}
+
+static void history_key(const void *array, size_t i, const char **binary, const char **test)
+{
+    const struct mu_history *entry = (const struct mu_history *)array + i;
+    *binary = entry->binary;
+    *test = entry->test;
+}
+
+/**
+ * Returns the slot of a key in index: the slot holding it, or the empty
+ * slot where it belongs.
+ */
+static size_t *index_slot(const struct mu_index *index, const void *array, mu_key_fn key,
+    const char *binary, const char *test)
+{
+    size_t mask = index->capacity - 1;
+    size_t pos = hash_key(binary, test) & mask;
+    while (index->slots[pos]) {
+        const char *b;
+        const char *t;
+        key(array, index->slots[pos] - 1, &b, &t);
+        if (strcmp(b, binary) == 0 && strcmp(t, test) == 0) break;
+        pos = (pos + 1) & mask;
+    }
+    return &index->slots[pos];
+}
+
+/*  Looks up a key; returns its array index, or -1 */
+static long index_find(const struct mu_index *index, const void *array, mu_key_fn key,
+    const char *binary, const char *test)
+{
+    if (!index->capacity) return -1;
+    return (long)*index_slot(index, array, key, binary, test) - 1;
+}
+
+/**
+ * Makes room in index for one more key, keeping it at most half full.
+ * count is the number of elements already indexed: 0 to count - 1.
+ */
+static void index_reserve(struct mu_index *index, const void *array, mu_key_fn key, size_t count)
+{
+    size_t i;
+    if ((count + 1) * 2 <= index->capacity) return;
+    free(index->slots);
+    index->capacity = index->capacity ? index->capacity * 2 : 64;
+    index->slots = (size_t *)xrealloc(NULL, index->capacity * sizeof(*index->slots));
+    memset(index->slots, 0, index->capacity * sizeof(*index->slots));
+    for (i = 0; i < count; i++) {
+        const char *b;
+        const char *t;
+        key(array, i, &b, &t);
+        *index_slot(index, array, key, b, t) = i + 1;
+    }
+}
+
+static struct mu_job *add_job(struct mu_job_list *list, const char *binary, const char *test)
+{
+    size_t *slot;
+    struct mu_job *job;
+
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 64;
+        list->items = (struct mu_job *)xrealloc(list->items, list->capacity * sizeof(*list->items));
+    }
+    index_reserve(&list->index, list->items, job_key, list->count);
+    slot = index_slot(&list->index, list->items, job_key, binary, test);
+    if (*slot) return &list->items[*slot - 1];
+
+    job = &list->items[list->count];
+    memset(job, 0, sizeof(*job));
+    job->binary = xstrdup(binary);
+    job->test = xstrdup(test);
+    job->expected = -1.0;
+    *slot = ++list->count;
+    return job;
+}
+
+/**
+ * Starts binary with args, sending its stdout and stderr to fd.
+ * Returns the child pid, or -1 on error.
+ */
+static pid_t spawn(const char *binary, char *const args[], int fd)
+{
+    pid_t pid = fork();
+    if (pid == 0) {
+        (void)dup2(fd, STDOUT_FILENO);
+        (void)dup2(fd, STDERR_FILENO);
+        (void)close(fd);
+        execv(binary, args);
+        fprintf(stderr, "mu_orchestrate: cannot run %s: %s\n", binary, strerror(errno));
+        _exit(127);
+    }
+    return pid;
+}
+
+/**
+ * Adds the jobs found by the discovery job of a binary: one per listed
+ * test. A binary that lists nothing has ignored --list and run its whole
+ * suite: that run becomes its single, finished job rather than being run
+ * a second time.
+ *
+ * The marker may follow other output on the same line, such as a color
+ * reset. Other lines from a binary that did list tests are reported, as
+ * they may hide a test.
+ */
+static void add_listed_tests(struct mu_job *probe)
+{
+    char line[MU_ORCHESTRATE_LINE_LEN];
+    size_t before = jobs.count;
+    size_t prefix = strlen(MU_ORCHESTRATE_LIST_PREFIX);
+    int unparsed = 0;
+    struct mu_job *job;
+    FILE *listing;
+
+    listing = probe->output[0] ? fopen(probe->output, "r") : NULL;
+    while (listing && fgets(line, sizeof(line), listing)) {
+        char *name = strstr(line, MU_ORCHESTRATE_LIST_PREFIX);
+        line[strcspn(line, "\r\n")] = '\0';
+        if (name && name[prefix]) {
+            add_job(&jobs, probe->binary, name + prefix);
+        } else if (line[0]) {
+            unparsed++;
+        }
+    }
+    if (listing) (void)fclose(listing);
+
+    if (jobs.count > before) {
+        if (unparsed) {
+            fprintf(stderr, "mu_orchestrate: %s: ignored %d unexpected line%s of --list output\n",
+                probe->binary, unparsed, unparsed == 1 ? "" : "s");
+        }
+        if (probe->output[0]) (void)unlink(probe->output);
+        return;
+    }
+    job = add_job(&jobs, probe->binary, MU_ORCHESTRATE_WHOLE);
+    job->duration = probe->duration;
+    job->status = probe->status;
+    job->done = 1;
+    strcpy(job->output, probe->output);
+}
+
+static int is_executable_file(const char *path)
+{
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISREG(st.st_mode) && access(path, X_OK) == 0 &&
+        !(st.st_dev == self.st_dev && st.st_ino == self.st_ino);
+}
+
+/**
+ * Adds the discovery job of a binary, or of every executable file in a
+ * directory.
+ */
+static void discover(const char *path)
+{
+    struct stat st;
+    char *binary;
+
+    if (stat(path, &st) == 0 && S_ISDIR(st.st_mode)) {
+        DIR *dir = opendir(path);
+        struct dirent *entry;
+        while (dir && (entry = readdir(dir)) != NULL) {
+            if (entry->d_name[0] == '.') continue;
+            binary = (char *)xrealloc(NULL, strlen(path) + strlen(entry->d_name) + 2);
+            sprintf(binary, "%s/%s", path, entry->d_name);
+            if (is_executable_file(binary)) add_job(&probes, binary, MU_ORCHESTRATE_LIST);
+            free(binary);
+        }
+        if (dir) (void)closedir(dir);
+        return;
+    }
+
+    if (!is_executable_file(path)) {
+        fprintf(stderr, "mu_orchestrate: %s is not an executable file\n", path);
+        return;
+    }
+
+    /* execv() does not search PATH, so bare names are taken as relative */
+    binary = (char *)xrealloc(NULL, strlen(path) + 3);
+    sprintf(binary, "%s%s", strchr(path, '/') ? "" : "./", path);
+    add_job(&probes, binary, MU_ORCHESTRATE_LIST);
+    free(binary);
+}
+
+/**
+ * Loads durations written by save_history(): one
+ * "<seconds>\t<binary>\t<test>" line per test.
+ */
+static void load_history(const char *path)
+{
+    char line[MU_ORCHESTRATE_LINE_LEN];
+    FILE *file = fopen(path, "r");
+
+    while (file && fgets(line, sizeof(line), file)) {
+        char *binary = strchr(line, '\t');
+        char *test = binary ? strchr(binary + 1, '\t') : NULL;
+        size_t *slot;
+        if (!test) continue;
+        *binary++ = '\0';
+        *test++ = '\0';
+        test[strcspn(test, "\r\n")] = '\0';
+
+        index_reserve(&history_index, history, history_key, history_count);
+        slot = index_slot(&history_index, history, history_key, binary, test);
+        if (*slot) {
+            history[*slot - 1].duration = atof(line);
+            continue;
+        }
+        history = (struct mu_history *)xrealloc(history, (history_count + 1) * sizeof(*history));
+        history[history_count].duration = atof(line);
+        history[history_count].binary = xstrdup(binary);
+        history[history_count].test = xstrdup(test);
+        *slot = ++history_count;
+    }
+    if (file) (void)fclose(file);
+}
+
+/**
+ * Writes the durations of this run, keeping entries for tests that did not
+ * run this time so that partial runs do not forget them.
+ */
+static void save_history(const char *path)
+{
+    char *temp = (char *)xrealloc(NULL, strlen(path) + 5);
+    FILE *file;
+    size_t i;
+
+    sprintf(temp, "%s.tmp", path);
+    file = fopen(temp, "w");
+    if (!file) {
+        fprintf(stderr, "mu_orchestrate: cannot write %s: %s\n", temp, strerror(errno));
+        free(temp);
+        return;
+    }
+    for (i = 0; i < jobs.count; i++) {
+        fprintf(file, "%.6f\t%s\t%s\n", jobs.items[i].duration, jobs.items[i].binary, jobs.items[i].test);
+    }
+    for (i = 0; i < history_count; i++) {
+        if (index_find(&jobs.index, jobs.items, job_key, history[i].binary, history[i].test) < 0) {
+            fprintf(file, "%.6f\t%s\t%s\n", history[i].duration, history[i].binary, history[i].test);
+        }
+    }
+    if (fclose(file) != 0 || rename(temp, path) != 0) {
+        fprintf(stderr, "mu_orchestrate: cannot write %s: %s\n", path, strerror(errno));
+    }
+    free(temp);
+}
+
+/*  Longest expected duration first; ties keep discovery order */
+static int compare_expected(const void *a, const void *b)
+{
+    const struct mu_job *x = *(const struct mu_job * const *)a;
+    const struct mu_job *y = *(const struct mu_job * const *)b;
+    if (x->expected != y->expected) return x->expected < y->expected ? 1 : -1;
+    return x < y ? -1 : (x > y);
+}
+
+/**
+ * Orders jobs longest-first (LPT scheduling). Tests without history are
+ * assumed to take as long as the longest known test, so that a new slow
+ * test cannot end up alone at the tail of the run. A discovery job is
+ * expected to take as long as its binary last took as a whole, which is
+ * next to nothing unless the binary ignores --list.
+ */
+static struct mu_job **schedule(struct mu_job_list *list)
+{
+    struct mu_job **order = (struct mu_job **)xrealloc(NULL, (list->count + 1) * sizeof(*order));
+    double longest = 0.0;
+    size_t i;
+
+    for (i = 0; i < list->count; i++) {
+        struct mu_job *job = &list->items[i];
+        const char *test = strcmp(job->test, MU_ORCHESTRATE_LIST) == 0 ? MU_ORCHESTRATE_WHOLE : job->test;
+        long found = index_find(&history_index, history, history_key, job->binary, test);
+        if (found >= 0) {
+            job->expected = history[found].duration;
+            if (job->expected > longest) longest = job->expected;
+        }
+    }
+    for (i = 0; i < list->count; i++) {
+        if (list->items[i].expected < 0) list->items[i].expected = longest;
+        order[i] = &list->items[i];
+    }
+    qsort(order, list->count, sizeof(*order), compare_expected);
+    return order;
+}
+
+static int start_job(struct mu_job *job)
+{
+    char *args[4];
+    int fd;
+
+    strcpy(job->output, "/tmp/mu_orchestrate.XXXXXX");
+    fd = mkstemp(job->output);
+    if (fd == -1) {
+        perror("mu_orchestrate: mkstemp");
+        job->output[0] = '\0';
+        return -1;
+    }
+    args[0] = job->binary;
+    if (strcmp(job->test, MU_ORCHESTRATE_WHOLE) == 0) {
+        args[1] = NULL;
+    } else if (strcmp(job->test, MU_ORCHESTRATE_LIST) == 0) {
+        args[1] = (char *)MU_ORCHESTRATE_LIST;
+        args[2] = NULL;
+    } else {
+        args[1] = (char *)"--run";
+        args[2] = job->test;
+        args[3] = NULL;
+    }
+    job->duration = now_seconds();
+    job->pid = spawn(job->binary, args, fd);
+    (void)close(fd);
+    return job->pid > 0 ? 0 : -1;
+}
+
+/**
+ * Runs count jobs in order, keeping at most workers of them running at
+ * once. Running jobs are kept in one slot per worker, so finding the job of
+ * a finished child never scans the whole job list.
+ */
+static void run_jobs(struct mu_job **order, size_t count, long workers)
+{
+    struct mu_job **running = (struct mu_job **)xrealloc(NULL, (size_t)workers * sizeof(*running));
+    size_t next = 0;
+    long active = 0;
+    long i;
+
+    while (next < count || active > 0) {
+        struct mu_job *job;
+        int status;
+        pid_t pid;
+
+        while (next < count && active < workers) {
+            job = order[next++];
+            if (job->done) continue;
+            if (start_job(job) == 0) {
+                running[active++] = job;
+            } else {
+                job->duration = 0.0;
+                job->status = 127 << 8;
+                job->pid = 0;
+            }
+        }
+        if (active == 0) continue;
+
+        pid = waitpid(-1, &status, 0);
+        if (pid == -1) {
+            if (errno == EINTR) continue;
+            perror("mu_orchestrate: waitpid");
+            exit(2);
+        }
+        for (i = 0; i < active; i++) {
+            job = running[i];
+            if (job->pid != pid) continue;
+            job->duration = now_seconds() - job->duration;
+            job->status = status;
+            job->pid = 0;
+            running[i] = running[--active];
+            break;
+        }
+    }
+    free(running);
+}
+
+static int job_failed(const struct mu_job *job)
+{
+    return !WIFEXITED(job->status) || WEXITSTATUS(job->status) != 0;
+}
+
+/**
+ * Writes the merged report, in discovery order, with the captured output
+ * of every failed test. Returns the number of failed tests.
+ */
+static int report(FILE *out, double wall)
+{
+    char line[MU_ORCHESTRATE_LINE_LEN];
+    double total = 0.0;
+    int failures = 0;
+    size_t i;
+
+    for (i = 0; i < jobs.count; i++) {
+        const struct mu_job *job = &jobs.items[i];
+        int failed = job_failed(job);
+        total += job->duration;
+
+        if (!failed) {
+            fprintf(out, "PASS  %9.3fs  %s %s\n", job->duration, job->binary, job->test);
+        } else {
+            FILE *output;
+            failures++;
+            if (WIFSIGNALED(job->status)) {
+                fprintf(out, "CRASH %9.3fs  %s %s (signal %d)\n", job->duration, job->binary, job->test, WTERMSIG(job->status));
+            } else {
+                fprintf(out, "FAIL  %9.3fs  %s %s (exit %d)\n", job->duration, job->binary, job->test, WEXITSTATUS(job->status));
+            }
+            output = job->output[0] ? fopen(job->output, "r") : NULL;
+            while (output && fgets(line, sizeof(line), output)) {
+                fprintf(out, "    | %s", line);
+                if (!strchr(line, '\n')) fputc('\n', out);
+            }
+            if (output) (void)fclose(output);
+        }
+        if (job->output[0]) (void)unlink(job->output);
+    }
+
+    fprintf(out, "\n%lu tests, %d failures, %.3f seconds (wall) %.3f seconds (tests)\n",
+        (unsigned long)jobs.count, failures, wall, total);
+    return failures;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: mu_orchestrate [-j workers] [-d durations] [-o report] path...\n");
+    exit(2);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *durations = MU_ORCHESTRATE_DURATIONS;
+    const char *report_path = NULL;
+    long workers = sysconf(_SC_NPROCESSORS_ONLN);
+    struct mu_job **order;
+    FILE *out = stdout;
+    double start;
+    int failures;
+    int opt;
+    size_t i;
+
+    while ((opt = getopt(argc, argv, "j:d:o:")) != -1) {
+        switch (opt) {
+        case 'j': workers = atol(optarg); break;
+        case 'd': durations = optarg; break;
+        case 'o': report_path = optarg; break;
+        default: usage();
+        }
+    }
+    if (optind == argc) usage();
+    if (workers < 1) workers = 1;
+    if (stat("/proc/self/exe", &self) != 0 && stat(argv[0], &self) != 0) {
+        memset(&self, 0, sizeof(self));
+    }
+
+    for (; optind < argc; optind++) discover(argv[optind]);
+    if (probes.count == 0) {
+        fprintf(stderr, "mu_orchestrate: no tests found\n");
+        return 2;
+    }
+    load_history(durations);
+    (void)fflush(stdout);
+    start = now_seconds();
+
+    /* Discovery runs on the pool too: binaries that ignore --list run in full */
+    order = schedule(&probes);
+    run_jobs(order, probes.count, workers);
+    free(order);
+    for (i = 0; i < probes.count; i++) add_listed_tests(&probes.items[i]);
+
+    order = schedule(&jobs);
+    run_jobs(order, jobs.count, workers);
+    free(order);
+
+    if (report_path) {
+        out = fopen(report_path, "w");
+        if (!out) {
+            fprintf(stderr, "mu_orchestrate: cannot write %s: %s\n", report_path, strerror(errno));
+            out = stdout;
+        }
+    }
+    failures = report(out, now_seconds() - start);
+    if (out != stdout) (void)fclose(out);
+
+    save_history(durations);
+    return failures ? 1 : 0;
+}